@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# ============================================================
+# scaling_sweep.sh — Strong/weak scaling sweep past 1/2/4 threads
+# Runs sieve_openmp for each executor at 1, 2, 4, ... up to the number of
+# CPUs (or the THREADS list) and prints rows in the docs/results/results.csv
+# schema: impl,N,threads,trial,time_sec,count,scaling,implementation
+#   impl = <executor>_strong  (fixed N)
+#          <executor>_weak    (N grows with threads: N_PER_THREAD * threads)
+# Usage: code/scaling_sweep.sh [path/to/sieve_openmp] >> docs/results/results.csv
+# Environment: N (default 1e9), N_PER_THREAD (default 2.5e8), TRIALS (3),
+#              EXECUTORS ("openmp numa"), THREADS ("1 2 4 ... nproc")
+# ============================================================
+
+set -euo pipefail
+
+BIN=${1:-build/sieve_openmp}
+N=${N:-1000000000}
+N_PER_THREAD=${N_PER_THREAD:-250000000}
+TRIALS=${TRIALS:-3}
+EXECUTORS=${EXECUTORS:-"openmp numa"}
+
+if [ -z "${THREADS:-}" ]; then
+    max=$(nproc)
+    THREADS=""
+    t=1
+    while [ "$t" -lt "$max" ]; do THREADS="$THREADS $t"; t=$((t * 2)); done
+    THREADS="$THREADS $max"
+fi
+
+# One run -> "count time_sec" from the driver's summary line
+run_one() {
+    "$BIN" "$1" "$2" --executor "$3" | tail -1 |
+        sed -E 's/.*count=([0-9]+) time_sec=([0-9.]+).*/\1 \2/'
+}
+
+for exe in $EXECUTORS; do
+    for threads in $THREADS; do
+        for scaling in strong weak; do
+            n=$N
+            [ "$scaling" = weak ] && n=$((N_PER_THREAD * threads))
+            for ((trial = 0; trial < TRIALS; trial++)); do
+                read -r count time_sec < <(run_one "$n" "$threads" "$exe")
+                impl="${exe}_${scaling}"
+                echo "$impl,$n,$threads,$trial,$time_sec,$count,$scaling,$impl"
+            done
+        done
+    done
+done
@@ -0,0 +1,34 @@
+// ============================================================
+// sieve_arena.hpp — Per-thread sieve state, allocated once per thread
+// Used by every executor in sieve_executors.hpp
+// - Each worker thread owns one SieveThreadState for the whole run:
+//   its segment bitset, its small-prime offsets, its large-prime
+//   buckets and its own copy of the wheel pattern (the small pattern
+//   bits; the aligned and pre-sieve tables stay shared, read-only)
+// - Buffers are created by the thread that uses them (first touch)
+//   and only reset in place afterwards, so the sieve loop never goes
+//   back to the heap allocator once the first run has warmed it up
+// - The struct is cache-line aligned so two threads' states never
+//   share a cache line
+// ============================================================
+
+#pragma once
+
+#include "sieve_bitset.hpp"
+#include "sieve_wheel.hpp"
+#include "sieve_buckets.hpp"
+#include "sieve_offsets.hpp"
+
+struct alignas(CACHE_LINE_BYTES) SieveThreadState {
+    SegmentBitset segment;
+    SmallPrimeOffsets offsets;
+    LargePrimeBuckets buckets;
+    WheelPattern wheel;
+
+    // Take a thread-local copy of the wheel (sharing its aligned tables)
+    // and size the segment buffer for the largest segment this thread will see
+    void init(const WheelPattern& shared_wheel, long long seg_bits) {
+        wheel = shared_wheel;
+        segment.reserve_bits(seg_bits);
+    }
+};
@@ -0,0 +1,144 @@
+// ============================================================
+// sieve_base_primes.hpp — Base primes up to sqrt(N), 64-bit limits
+// Used by build_range_context() in sieve_engine.hpp
+// - Primes are returned as uint32_t: sqrt(N) < 2^32 for every N < 2^63,
+//   so a 4-byte entry always fits (an int tops out at sqrt(N) = 2^31)
+// - simple_sieve(): below 2^16 a prefix of the compile-time table
+//   (sieve_small_primes.hpp), above that one flat byte array
+// - generate_base_primes(): for large limits (windows near 1e18 need
+//   ~5e7 base primes up to 1e9) the range is split into blocks that are
+//   sieved in parallel by std::thread workers, each block with its own
+//   word-packed bitset and the "primes of the primes" up to limit^(1/2).
+//   Blocks start from the 30030 wheel pattern (multiples of 3..13 are
+//   already gone) and are collected in order, so the result stays sorted.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "sieve_bitset.hpp"
+#include "sieve_small_primes.hpp"
+#include "sieve_wheel.hpp"
+
+// Below this limit the flat sieve is faster than starting threads
+static const long long SERIAL_BASE_PRIME_LIMIT = 1LL << 22;
+
+// Odd numbers per block of the parallel generator (256 KiB of bitset)
+static const long long BASE_PRIME_BLOCK_BITS = 256LL * 1024 * 8;
+
+// floor(sqrt(n)) for 0 <= n < 2^63, exact (no floating-point rounding)
+inline long long integer_sqrt(long long n) {
+    if (n <= 0) return 0;
+    long long r = (long long)std::sqrt((long double)n);
+    while (r > 0 && r > n / r) r--;
+    while ((r + 1) <= n / (r + 1)) r++;
+    return r;
+}
+
+// ------------------------------------------------------------
+// Small limits: sequential simple sieve
+// ------------------------------------------------------------
+inline std::vector<uint32_t> simple_sieve(long long limit) {
+    std::vector<uint32_t> primes;
+    if (limit < 2) return primes;
+    if (limit < SMALL_PRIME_BOUND) {
+        auto end = std::upper_bound(SMALL_PRIMES.begin(), SMALL_PRIMES.end(), (uint32_t)limit);
+        return std::vector<uint32_t>(SMALL_PRIMES.begin(), end);
+    }
+
+    // One byte per number is fine here: limit is small
+    std::vector<char> is_prime((size_t)limit + 1, 1);
+    is_prime[0] = 0;
+    is_prime[1] = 0;
+
+    for (long long i = 2; i * i <= limit; i++) {
+        if (is_prime[(size_t)i]) {
+            for (long long j = i * i; j <= limit; j += i) is_prime[(size_t)j] = 0;
+        }
+    }
+
+    for (long long i = 2; i <= limit; i++) {
+        if (is_prime[(size_t)i]) primes.push_back((uint32_t)i);
+    }
+    return primes;
+}
+
+// ------------------------------------------------------------
+// Large limits: segmented, parallel
+// ------------------------------------------------------------
+
+// Odd primes in the block of odd numbers low, low+2, ... (num_bits of them),
+// crossed off with the seed primes not in the wheel; appended to out in order
+inline void sieve_base_prime_block(const std::vector<uint32_t>& seeds, const WheelPattern& wheel,
+                                   long long low, long long num_bits,
+                                   SegmentBitset& block, std::vector<uint32_t>& out) {
+    wheel.fill(block, low, num_bits);
+    long long high = low + 2 * (num_bits - 1);
+
+    for (uint32_t seed : seeds) {
+        long long p = seed;
+        if (p <= wheel.largest_prime()) continue;
+        if (p * p > high) break;
+
+        // First odd multiple of p that is >= max(p^2, low)
+        long long start = std::max(p * p, ((low + p - 1) / p) * p);
+        if (start % 2 == 0) start += p;
+        for (long long idx = (start - low) / 2; idx < num_bits; idx += p) block.clear(idx);
+    }
+
+    block.for_each_set([&](long long value) { out.push_back((uint32_t)value); });
+}
+
+// All primes <= limit (limit < 2^32), using up to num_threads threads
+inline std::vector<uint32_t> generate_base_primes(long long limit, int num_threads) {
+    if (limit < SERIAL_BASE_PRIME_LIMIT) return simple_sieve(limit);
+    if (num_threads < 1) num_threads = 1;
+
+    // Seed primes up to sqrt(limit) (at most 65536 for limit < 2^32)
+    std::vector<uint32_t> seeds = simple_sieve(integer_sqrt(limit));
+    WheelPattern wheel;
+    wheel.build(30030);
+
+    // Odd numbers 3, 5, ..., limit split into fixed-size blocks
+    long long total_bits = (limit - 3) / 2 + 1;
+    long long num_blocks = (total_bits + BASE_PRIME_BLOCK_BITS - 1) / BASE_PRIME_BLOCK_BITS;
+    std::vector<std::vector<uint32_t>> block_primes((size_t)num_blocks);
+
+    std::atomic<long long> next_block(0);
+    auto worker = [&]() {
+        SegmentBitset block;
+        block.reserve_bits(BASE_PRIME_BLOCK_BITS);
+        for (;;) {
+            long long b = next_block.fetch_add(1, std::memory_order_relaxed);
+            if (b >= num_blocks) break;
+            long long first_bit = b * BASE_PRIME_BLOCK_BITS;
+            long long bits = std::min(BASE_PRIME_BLOCK_BITS, total_bits - first_bit);
+            sieve_base_prime_block(seeds, wheel, 3 + 2 * first_bit, bits, block,
+                                   block_primes[(size_t)b]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    int workers = (int)std::min<long long>(num_threads, num_blocks);
+    for (int t = 1; t < workers; t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& th : pool) th.join();
+
+    // Concatenate the blocks in order (2 first)
+    size_t total = 1;
+    for (const auto& v : block_primes) total += v.size();
+    std::vector<uint32_t> primes;
+    primes.reserve(total);
+    primes.push_back(2);
+    for (auto& v : block_primes) {
+        primes.insert(primes.end(), v.begin(), v.end());
+        std::vector<uint32_t>().swap(v);
+    }
+    return primes;
+}
@@ -0,0 +1,320 @@
+// ============================================================
+// sieve_bench.cpp — In-process benchmark harness for the shared engine
+// Replaces shelling out to the drivers and parsing their output:
+// - the setup (base primes, wheel, geometry) is built once per
+//   configuration and timed separately, so trials time the sieve only
+// - warmup runs, then repeated trials; median, p95 and min per config
+// - cycles, instructions (IPC) and LLC misses per trial through
+//   perf_event when the kernel allows it (see sieve_perf.hpp)
+// - sweep over every combination of N, executor, threads, segment
+//   size and wheel; counts must agree for the same N, or the run fails
+// - one row per trial in the docs/results/results.csv schema:
+//   impl,N,threads,trial,time_sec,count,scaling,implementation
+//   impl = executor, implementation = <executor>_seg<B>_wheel<M>
+// Usage: ./sieve_bench [--n 1e8,1e9] [--threads 1,2,4] [--executor openmp,pool]
+//                      [--segment-bytes 0,32768] [--wheel 30030] [--trials 5]
+//                      [--warmup 1] [--csv results.csv]
+//        ./sieve_bench --cache <file> --lookups <count> [--hugepages off|thp|2m|1g]
+//                      [--trials 5] [--warmup 1]
+// Lists are comma-separated; N accepts 1e9-style values. Rows are
+// appended to --csv (header written when the file is new).
+// Lookup mode times random is_prime(x) on a prime cache, each lookup
+// depending on the previous answer (latency, not throughput); the cache
+// is loaded into memory on huge pages unless --hugepages off.
+// Output: one summary line per configuration on stdout
+// ============================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sieve_executors.hpp"
+#include "sieve_cli.hpp"
+#include "sieve_perf.hpp"
+
+using namespace std;
+
+struct BenchArgs {
+    vector<long long> n_values = {100000000LL};
+    vector<long long> thread_counts = {1};
+    vector<SieveExecutor> executors = {SieveExecutor::Serial};
+    vector<long long> segment_sizes = {0};
+    vector<long long> wheels = {DEFAULT_WHEEL};
+    int trials = 5;
+    int warmup = 1;
+    string csv_path;   // empty = no CSV
+    string cache_path;           // lookup mode: prime cache to query
+    long long lookups = 1000000;
+    HugePagePolicy hugepages = HugePagePolicy::Transparent;
+};
+
+// ------------------------------------------------------------
+// Step 1: Parse the sweep
+// ------------------------------------------------------------
+
+vector<string> split_list(const string& text) {
+    vector<string> items;
+    size_t i = 0;
+    while (i <= text.size()) {
+        size_t end = text.find(',', i);
+        if (end == string::npos) end = text.size();
+        if (end > i) items.push_back(text.substr(i, end - i));
+        i = end + 1;
+    }
+    return items;
+}
+
+bool parse_bench_args(int argc, char* argv[], BenchArgs& args) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+            return false;
+        }
+        string value = argv[++i];
+        vector<long long> numbers;
+        bool numeric = arg == "--n" || arg == "--threads" || arg == "--segment-bytes" ||
+                       arg == "--wheel" || arg == "--lookups";
+        for (const string& item : numeric ? split_list(value) : vector<string>()) {
+            long long number = 0;
+            if (!parse_count(item, number)) return false;
+            numbers.push_back(number);
+        }
+
+        if (arg == "--n") {
+            args.n_values = numbers;
+        } else if (arg == "--threads") {
+            args.thread_counts = numbers;
+        } else if (arg == "--segment-bytes") {
+            args.segment_sizes = numbers;
+        } else if (arg == "--wheel") {
+            args.wheels = numbers;
+        } else if (arg == "--trials") {
+            args.trials = atoi(value.c_str());
+        } else if (arg == "--warmup") {
+            args.warmup = atoi(value.c_str());
+        } else if (arg == "--csv") {
+            args.csv_path = value;
+        } else if (arg == "--cache") {
+            args.cache_path = value;
+        } else if (arg == "--lookups") {
+            args.lookups = numbers.empty() ? 0 : numbers[0];
+        } else if (arg == "--hugepages") {
+            if (!parse_huge_page_policy(value, args.hugepages)) {
+                fprintf(stderr, "Unknown huge page policy %s (use off, thp, 2m or 1g)\n", value.c_str());
+                return false;
+            }
+        } else if (arg == "--executor") {
+            args.executors.clear();
+            for (const string& name : split_list(value)) {
+                SieveExecutor e;
+                if (!parse_executor_name(name, e)) {
+                    fprintf(stderr, "Unknown executor %s (use serial, openmp, pool, numa, steal or pipeline)\n",
+                            name.c_str());
+                    return false;
+                }
+                args.executors.push_back(e);
+            }
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    if (args.trials < 1) args.trials = 1;
+    if (args.warmup < 0) args.warmup = 0;
+    for (long long w : args.wheels) {
+        WheelPattern check;
+        if (!check.build(w)) {
+            fprintf(stderr, "Unsupported wheel modulus %lld (use 2, 6, 30, 210, 2310, 30030 or 510510)\n", w);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// Step 2: Statistics over the trials
+// ------------------------------------------------------------
+
+// Nearest-rank percentile (q in [0, 1]) of an already sorted list
+double percentile(const vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)ceil(q * (double)sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+long long median_of(vector<long long> values) {
+    if (values.empty()) return 0;
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// ------------------------------------------------------------
+// Step 3: One configuration: build once, warm up, time the trials
+// ------------------------------------------------------------
+struct TrialResult {
+    double time_sec = 0;
+    long long count = 0;
+    PerfSample perf;
+};
+
+vector<TrialResult> bench_config(const SieveOptions& options, long long N, const BenchArgs& args,
+                                 PerfCounters& perf, double& setup_sec) {
+    SieveTrace trace;   // disabled: no per-segment bookkeeping in the timed loop
+    SieveContext ctx;
+    double t0 = trace_now();
+    build_sieve_context(N, options, ctx, trace);
+    setup_sec = trace_now() - t0;
+
+    for (int w = 0; w < args.warmup; w++) run_executor(ctx, options, trace, NoSegmentVisitor());
+
+    vector<TrialResult> results;
+    for (int t = 0; t < args.trials; t++) {
+        TrialResult r;
+        perf.start();
+        double start = trace_now();
+        r.count = run_executor(ctx, options, trace, NoSegmentVisitor());
+        r.time_sec = trace_now() - start;
+        r.perf = perf.stop();
+        results.push_back(r);
+    }
+    return results;
+}
+
+// ------------------------------------------------------------
+// Lookup mode: random is_prime(x) latency on a prime cache
+// ------------------------------------------------------------
+int run_lookup_bench(const BenchArgs& args) {
+    PrimeCache cache;
+    double t0 = trace_now();
+    if (!cache.open(args.cache_path, args.hugepages) || cache.limit() < 1) {
+        fprintf(stderr, "Could not open prime cache %s\n", args.cache_path.c_str());
+        return 1;
+    }
+    double load_sec = trace_now() - t0;
+
+    // The next x mixes in the running hit count, so every lookup waits
+    // for the previous one
+    uint64_t x = 719;
+    long long hits = 0;
+    vector<double> ns;
+    for (int t = -args.warmup; t < args.trials; t++) {
+        double start = trace_now();
+        for (long long i = 0; i < args.lookups; i++) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL + (uint64_t)hits;
+            hits += cache.is_prime((long long)((x >> 16) % (uint64_t)cache.limit())) ? 1 : 0;
+        }
+        double elapsed = trace_now() - start;
+        if (t >= 0 && args.lookups > 0) ns.push_back(elapsed * 1e9 / (double)args.lookups);
+    }
+    sort(ns.begin(), ns.end());
+
+    // Measured after the lookups touched the buffer (THP pages appear on first touch)
+    const HugePageBuffer& memory = cache.memory();
+    printf("mode=lookup limit=%lld lookups=%lld hugepages=%s huge_bytes=%zu in_memory_bytes=%zu "
+           "load_sec=%.6f median_ns=%.2f p95_ns=%.2f min_ns=%.2f hits=%lld\n",
+           cache.limit(), args.lookups, huge_page_backing_name(memory.backing()), memory.huge_bytes(),
+           memory.size(), load_sec, percentile(ns, 0.5), percentile(ns, 0.95), ns.empty() ? 0.0 : ns.front(),
+           hits);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (!parse_bench_args(argc, argv, args)) return 1;
+    if (!args.cache_path.empty()) return run_lookup_bench(args);
+
+    // Opened before any worker thread exists, so every thread inherits the counters
+    PerfCounters perf;
+    if (!perf.open()) fprintf(stderr, "perf_event counters unavailable; reporting times only\n");
+
+    FILE* csv = nullptr;
+    if (!args.csv_path.empty()) {
+        FILE* existing = fopen(args.csv_path.c_str(), "r");
+        bool is_new = existing == nullptr;
+        if (existing) fclose(existing);
+        csv = fopen(args.csv_path.c_str(), "a");
+        if (!csv) {
+            fprintf(stderr, "Could not open %s\n", args.csv_path.c_str());
+            return 1;
+        }
+        if (is_new) fprintf(csv, "impl,N,threads,trial,time_sec,count,scaling,implementation\n");
+    }
+
+    map<long long, long long> expected;   // N -> count seen in the first config
+    bool mismatch = false;
+
+    for (long long N : args.n_values) {
+        for (SieveExecutor executor : args.executors) {
+            for (size_t ti = 0; ti < args.thread_counts.size(); ti++) {
+                // The serial executor ignores threads: run it once, as 1 thread
+                long long threads = args.thread_counts[ti];
+                if (executor == SieveExecutor::Serial) {
+                    if (ti > 0) break;
+                    threads = 1;
+                }
+                for (long long segment_bytes : args.segment_sizes) {
+                    for (long long wheel : args.wheels) {
+                        SieveOptions options;
+                        options.executor = executor;
+                        options.threads = (int)max(1LL, threads);
+                        options.segment_bytes = segment_bytes;
+                        options.wheel_modulus = wheel;
+
+                        double setup_sec = 0;
+                        vector<TrialResult> results = bench_config(options, N, args, perf, setup_sec);
+
+                        const char* impl = executor_name(executor);
+                        long long seg = segment_bytes > 0 ? normalize_segment_bytes(segment_bytes)
+                                                          : default_segment_bytes(detect_cache_info());
+                        string implementation = string(impl) + "_seg" + to_string(seg) + "_wheel" + to_string(wheel);
+
+                        vector<double> times;
+                        vector<long long> cycles, instructions, misses;
+                        for (size_t t = 0; t < results.size(); t++) {
+                            const TrialResult& r = results[t];
+                            times.push_back(r.time_sec);
+                            if (r.perf.valid) {
+                                cycles.push_back(r.perf.cycles);
+                                instructions.push_back(r.perf.instructions);
+                                misses.push_back(r.perf.llc_misses);
+                            }
+                            if (csv) {
+                                fprintf(csv, "%s,%lld,%d,%zu,%.6f,%lld,,%s\n", impl, N, options.threads,
+                                        t, r.time_sec, r.count, implementation.c_str());
+                            }
+                            auto it = expected.find(N);
+                            if (it == expected.end()) {
+                                expected[N] = r.count;
+                            } else if (it->second != r.count) {
+                                fprintf(stderr, "Count mismatch for N=%lld (%s, trial %zu): %lld vs %lld\n",
+                                        N, implementation.c_str(), t, r.count, it->second);
+                                mismatch = true;
+                            }
+                        }
+                        sort(times.begin(), times.end());
+
+                        printf("impl=%s N=%lld threads=%d segment_bytes=%lld wheel=%lld count=%lld "
+                               "setup_sec=%.6f median_sec=%.6f p95_sec=%.6f min_sec=%.6f",
+                               impl, N, options.threads, seg, wheel, results.front().count,
+                               setup_sec, percentile(times, 0.5), percentile(times, 0.95), times.front());
+                        if (!cycles.empty()) {
+                            long long c = median_of(cycles), ins = median_of(instructions);
+                            printf(" cycles=%lld instructions=%lld ipc=%.3f llc_misses=%lld",
+                                   c, ins, c > 0 ? (double)ins / (double)c : 0.0, median_of(misses));
+                        }
+                        printf("\n");
+                        fflush(stdout);
+                    }
+                }
+            }
+        }
+    }
+
+    if (csv) fclose(csv);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+// ============================================================
+// sieve_bitset.hpp — Word-packed odd-only segment bitset
+// Shared by sieve_serial.cpp and sieve_openmp.cpp
+// - Bit i of a segment stands for the odd number low + 2*i
+// - 1 = prime candidate, 0 = composite
+// - Backed by raw uint64_t words (no vector<bool> proxy objects)
+// - Tail word is masked once in reset(), so count() is a plain
+//   popcount over whole words with no per-element range checks
+//   (VPOPCNTQ where available, see sieve_simd.hpp)
+// - Word storage is cache-line aligned, so a thread's segment never
+//   shares a line with another thread's data
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "sieve_simd.hpp"
+
+// Hardware popcount on x86-64 without needing -mpopcnt on the command line.
+// Other targets fall back to the compiler's generic builtin.
+#if defined(__x86_64__) || defined(__i386__)
+#define SIEVE_POPCNT_TARGET __attribute__((target("popcnt")))
+#else
+#define SIEVE_POPCNT_TARGET
+#endif
+
+static const size_t CACHE_LINE_BYTES = 64;
+
+// Minimal allocator that hands out cache-line aligned storage
+template <typename T>
+struct CacheAlignedAllocator {
+    using value_type = T;
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_BYTES)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(CACHE_LINE_BYTES));
+    }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+};
+
+// Number of set bits in n bytes starting at p (any alignment)
+SIEVE_POPCNT_TARGET inline long long popcount_bytes(const uint8_t* p, size_t n) {
+    long long total = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        total += __builtin_popcountll(w);
+    }
+    for (; i < n; i++) total += __builtin_popcount(p[i]);
+    return total;
+}
+
+struct SegmentBitset {
+    std::vector<uint64_t, CacheAlignedAllocator<uint64_t>> words;
+    long long low = 0;       // odd number represented by bit 0
+    long long num_bits = 0;  // number of odd values in this segment
+
+    // Point the bitset at a new segment without touching the bit contents.
+    // The word vector only grows, so reusing one SegmentBitset across segments
+    // does not reallocate.
+    void prepare(long long low_value, long long bits) {
+        low = low_value;
+        num_bits = bits;
+
+        size_t num_words = (size_t)((bits + 63) / 64);
+        if (words.size() < num_words) words.resize(num_words);
+    }
+
+    // Allocate room for segments of up to bits bits ahead of time
+    void reserve_bits(long long bits) {
+        size_t num_words = (size_t)((bits + 63) / 64);
+        if (words.size() < num_words) words.resize(num_words);
+    }
+
+    // Clear the unused bits of the last word so count() can popcount it whole
+    void mask_tail() {
+        int tail_bits = (int)(num_bits & 63);
+        if (tail_bits != 0) words[word_count() - 1] &= (1ULL << tail_bits) - 1;
+    }
+
+    // Set every bit in [0, bits) to 1 and clear the unused tail of the last word
+    void reset(long long low_value, long long bits) {
+        prepare(low_value, bits);
+        size_t num_words = word_count();
+        for (size_t w = 0; w < num_words; w++) words[w] = ~0ULL;
+        mask_tail();
+    }
+
+    size_t word_count() const { return (size_t)((num_bits + 63) / 64); }
+
+    inline void clear(long long i) {
+        words[(size_t)(i >> 6)] &= ~(1ULL << (i & 63));
+    }
+
+    inline void set(long long i) {
+        words[(size_t)(i >> 6)] |= 1ULL << (i & 63);
+    }
+
+    inline bool test(long long i) const {
+        return (words[(size_t)(i >> 6)] >> (i & 63)) & 1ULL;
+    }
+
+    // Number of surviving candidates (bits still set)
+    long long count() const {
+        return simd_kernels().count_words(words.data(), word_count());
+    }
+
+    // Call f(value) for every surviving candidate, in increasing order.
+    // Walks set bits a word at a time, so sparse segments are cheap.
+    template <typename F>
+    void for_each_set(F&& f) const {
+        size_t n = word_count();
+        for (size_t w = 0; w < n; w++) {
+            uint64_t bits = words[w];
+            while (bits != 0) {
+                long long i = (long long)(w * 64) + __builtin_ctzll(bits);
+                f(low + 2 * i);
+                bits &= bits - 1;
+            }
+        }
+    }
+};
@@ -0,0 +1,135 @@
+// ============================================================
+// sieve_buckets.hpp — Bucket sieve for large base primes
+// Shared by sieve_serial.cpp and sieve_openmp.cpp
+// (after T. Oliveira e Silva's cache-friendly segmented sieve)
+// - A "large" prime p has bit step p >= segment length, so it hits
+//   a segment at most once and skips most segments entirely
+// - Instead of visiting every large prime in every segment, each
+//   prime is filed in the bucket of the segment that holds its next
+//   odd multiple, together with the bit index of that multiple
+// - Sieving a segment drains its bucket, clears one bit per entry and
+//   re-files the prime into the bucket of its following hit
+// - Buckets form a ring indexed by segment number mod ring size, so
+//   per-segment work scales with the number of hits, not primes
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "sieve_bitset.hpp"
+#include "sieve_offsets.hpp"
+
+struct BucketEntry {
+    uint32_t prime;  // base prime p (p <= sqrt(N) < 2^32)
+    uint32_t index;  // bit index of its next odd multiple inside the target segment
+};
+
+class LargePrimeBuckets {
+public:
+    // Prepare the buckets for the contiguous run of segments [seg_begin, seg_end).
+    // Segment s covers seg_bits odd numbers starting at first_value + 2*seg_bits*s
+    // (first_value must be odd). Only primes[first_large..] are filed here.
+    // primes must stay alive (and unchanged) while the run is being sieved.
+    void init(const std::vector<uint32_t>& primes, size_t first_large,
+              long long first_value, long long seg_bits,
+              long long seg_begin, long long seg_end) {
+        primes_ = &primes;
+        first_value_ = first_value;
+        seg_bits_ = seg_bits;
+        seg_end_ = seg_end;
+
+        long long max_prime = primes.empty() ? 0 : primes.back();
+        num_buckets_ = (size_t)(max_prime / seg_bits + 2);
+        if (buckets_.size() < num_buckets_) buckets_.resize(num_buckets_);
+        for (size_t b = 0; b < num_buckets_; b++) buckets_[b].clear();
+
+        long long run_low = first_value + 2 * seg_bits * seg_begin;
+
+        next_pending_ = first_large;
+        while (next_pending_ < primes.size()) {
+            long long p = primes[next_pending_];
+
+            // Primes whose square lies beyond run_low start at p^2; those are
+            // filed lazily by file_pending() once the ring reaches them
+            if (p * p > run_low) break;
+
+            // First odd multiple of p that is >= run_low
+            file(p, (run_low - first_value) / 2 + first_odd_multiple_index(run_low, p));
+            next_pending_++;
+        }
+    }
+
+    // Cross off every large-prime hit in segment s (seg must hold that segment).
+    // Returns the number of bits cleared.
+    long long sieve_segment(SegmentBitset& seg, long long s) {
+        file_pending(s);
+
+        std::vector<BucketEntry>& bucket = buckets_[(size_t)(s % (long long)num_buckets_)];
+        long long marks = 0;
+
+        for (const BucketEntry& e : bucket) {
+            long long idx = e.index;
+
+            // Only the final segment of the range can be shorter than seg_bits
+            if (idx < seg.num_bits) {
+                seg.clear(idx);
+                marks++;
+            }
+
+            // Re-file p into the bucket of the segment holding its next odd multiple
+            long long next = idx + e.prime;
+            long long advance = next / seg_bits_;
+            long long target = s + advance;
+            if (target < seg_end_) {
+                BucketEntry moved = {e.prime, (uint32_t)(next - advance * seg_bits_)};
+                buckets_[(size_t)(target % (long long)num_buckets_)].push_back(moved);
+            }
+        }
+
+        // advance >= 1 for every large prime, so nothing was re-filed into this bucket
+        bucket.clear();
+        return marks;
+    }
+
+private:
+    // File prime p whose next odd multiple sits at bit offset `offset` from first_value
+    void file(long long p, long long offset) {
+        long long s = offset / seg_bits_;
+        if (s >= seg_end_) return; // no hit inside this run
+
+        BucketEntry e = {(uint32_t)p, (uint32_t)(offset - s * seg_bits_)};
+        buckets_[(size_t)(s % (long long)num_buckets_)].push_back(e);
+    }
+
+    // Bring in primes whose first multiple p^2 falls inside the ring window
+    // [s, s + num_buckets). Filing them earlier would alias a ring slot that
+    // is still in use by an earlier segment.
+    void file_pending(long long s) {
+        long long window_end = s + (long long)num_buckets_;
+        while (next_pending_ < primes_->size()) {
+            long long p = (*primes_)[next_pending_];
+            long long offset = (p * p - first_value_) / 2;
+            long long target = offset / seg_bits_;
+            if (target >= window_end || target >= seg_end_) break;
+            file(p, offset);
+            next_pending_++;
+        }
+    }
+
+    std::vector<std::vector<BucketEntry>> buckets_;
+    size_t num_buckets_ = 0;
+    const std::vector<uint32_t>* primes_ = nullptr;
+    size_t next_pending_ = 0;
+    long long first_value_ = 3;
+    long long seg_bits_ = 1;
+    long long seg_end_ = 0;
+};
+
+// Index of the first base prime that belongs in the buckets (p >= seg_bits)
+inline size_t first_large_prime_index(const std::vector<uint32_t>& primes, long long seg_bits) {
+    return (size_t)(std::lower_bound(primes.begin(), primes.end(), seg_bits) - primes.begin());
+}
@@ -0,0 +1,345 @@
+// ============================================================
+// sieve_cli.hpp — Command-line parsing shared by the sieve drivers
+// Positional arguments: <N> [threads]   (threads only if the driver
+// takes them; with --range the N is dropped: [threads]). Flags may
+// appear anywhere:
+//   --range <A> <B>         only the primes in [A, B] (no sieving below A)
+//   --print                 write every prime found, one per line
+//   --output <file>         write the sieve to a binary file (sieve_output.hpp)
+//   --output-format <f>     bitmap (default) | gaps
+//   --cache <file>          answer from a prime cache (sieve_prime_cache.hpp)
+//                           if it covers the request; otherwise sieve and
+//                           (for [2, N] runs) save the result as the cache
+//   --wheel <modulus>       2 (off), 6, 30, 210, 2310, 30030, 510510
+//   --segment-bytes <B>     segment size in bytes of bitset (0 = auto)
+//   --presieve <limit>      pre-sieve patterns for primes up to limit
+//                           (0 = off, at most MAX_PRESIEVE_LIMIT = 256)
+//   --simd <level>          auto | scalar | avx2 | avx512 (sieve_simd.hpp)
+//   --executor <name>       serial | openmp | pool | numa | steal | pipeline
+//   --trace <file.json>     write per-thread counters as JSON at exit
+//   --method <m>            sieve (default) | lmo: count only, with the
+//                           combinatorial pi(x) of sieve_lmo.hpp
+//   --stats                 also report twin / k-tuple counts and the
+//                           largest gap, in the same pass (sieve_stats.hpp)
+//   --checkpoint <file>     run as a resumable job (sieve_job.hpp): save
+//                           progress to file, resume from it if it exists
+//   --checkpoint-every <s>  seconds between checkpoint writes (default 30)
+//   --deadline <s>          stop after s seconds (job; partial count)
+//   --progress <s>          progress line (segments/s, ETA) on stderr every s seconds
+//                           (job flags: not with --executor, jobs schedule their own blocks)
+// ============================================================
+
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_job.hpp"
+#include "sieve_output.hpp"
+#include "sieve_prime_cache.hpp"
+
+// How a count-only run gets its answer
+enum class CountMethod {
+    Sieve,   // sieve every segment and count the survivors
+    Lmo      // pi(B) - pi(A - 1) from Lagarias–Miller–Odlyzko (sieve_lmo.hpp)
+};
+
+struct SieveArgs {
+    long long N = 0;          // upper end (B in range mode)
+    long long A = 0;          // lower end, only used in range mode
+    bool range = false;       // --range A B was given
+    bool print_primes = false;
+    std::string output_path;  // empty = no binary output
+    SieveFileFormat output_format = SieveFileFormat::Bitmap;
+    std::string cache_path;   // empty = no prime cache
+    SieveOptions options;
+    std::string trace_path;   // empty = no trace
+    CountMethod method = CountMethod::Sieve;
+    bool stats = false;       // --stats: gap and k-tuple statistics
+    JobOptions job;           // --checkpoint / --deadline / --progress
+
+    // Count-only run through run_sieve_job (sieve_job.hpp)
+    bool job_mode() const {
+        return !job.checkpoint_path.empty() || job.deadline_sec > 0 || job.progress_interval_sec > 0;
+    }
+};
+
+inline bool parse_executor_name(const std::string& name, SieveExecutor& out) {
+    if (name == "serial") { out = SieveExecutor::Serial; return true; }
+    if (name == "openmp") { out = SieveExecutor::OpenMP; return true; }
+    if (name == "pool")   { out = SieveExecutor::ThreadPool; return true; }
+    if (name == "numa")   { out = SieveExecutor::Numa; return true; }
+    if (name == "steal")  { out = SieveExecutor::WorkStealing; return true; }
+    if (name == "pipeline") { out = SieveExecutor::Pipeline; return true; }
+    return false;
+}
+
+inline const char* executor_name(SieveExecutor e) {
+    switch (e) {
+        case SieveExecutor::OpenMP:       return "openmp";
+        case SieveExecutor::ThreadPool:   return "pool";
+        case SieveExecutor::Numa:         return "numa";
+        case SieveExecutor::WorkStealing: return "steal";
+        case SieveExecutor::Pipeline:     return "pipeline";
+        case SieveExecutor::Serial:
+        default:                          return "serial";
+    }
+}
+
+// --presieve value: a whole number in [0, MAX_PRESIEVE_LIMIT].
+// Prints a message to stderr and returns false otherwise.
+inline bool parse_presieve_limit(const char* text, int& out) {
+    char* end = nullptr;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value < 0 || value > MAX_PRESIEVE_LIMIT) {
+        fprintf(stderr, "Bad pre-sieve limit %s (use 0 to %d)\n", text, MAX_PRESIEVE_LIMIT);
+        return false;
+    }
+    out = (int)value;
+    return true;
+}
+
+// A count such as "1e9" or "1000000000": a whole number in [0, 2^63).
+// Prints a message to stderr and returns false otherwise.
+inline bool parse_count(const std::string& text, long long& out) {
+    const char* s = text.c_str();
+    char* end = nullptr;
+    bool ok = false;
+    if (text.find_first_of("eE.") != std::string::npos) {
+        double value = strtod(s, &end);
+        ok = end != s && *end == '\0' && value >= 0 && value < 9223372036854775808.0 &&
+             value == std::floor(value);
+        if (ok) out = llround(value);
+    } else {
+        errno = 0;
+        long long value = strtoll(s, &end, 10);
+        ok = end != s && *end == '\0' && errno == 0 && value >= 0;
+        if (ok) out = value;
+    }
+    if (!ok) fprintf(stderr, "Bad count %s (need a whole number from 0 to 2^63-1)\n", s);
+    return ok;
+}
+
+// Parse argv into args (which holds the driver's defaults on entry).
+// Prints a message to stderr and returns false on a bad argument.
+inline bool parse_sieve_args(int argc, char* argv[], bool takes_threads, SieveArgs& args) {
+    std::vector<const char*> positional;
+    bool executor_given = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--range" && i + 2 < argc) {
+            args.range = true;
+            args.A = atoll(argv[++i]);
+            args.N = atoll(argv[++i]);
+        } else if (arg == "--print") {
+            args.print_primes = true;
+        } else if (arg == "--wheel" && has_value) {
+            args.options.wheel_modulus = atoll(argv[++i]);
+        } else if (arg == "--segment-bytes" && has_value) {
+            args.options.segment_bytes = atoll(argv[++i]);
+        } else if (arg == "--presieve" && has_value) {
+            if (!parse_presieve_limit(argv[++i], args.options.presieve_limit)) return false;
+        } else if (arg == "--simd" && has_value) {
+            std::string name = argv[++i];
+            SimdLevel level = detect_simd_level();
+            if (name != "auto" && !parse_simd_level(name, level)) {
+                fprintf(stderr, "Unknown SIMD level %s (use auto, scalar, avx2 or avx512)\n", argv[i]);
+                return false;
+            }
+            if (!set_simd_level(level)) {
+                fprintf(stderr, "This CPU does not support %s (best is %s)\n",
+                        simd_level_name(level), simd_level_name(detect_simd_level()));
+                return false;
+            }
+        } else if (arg == "--executor" && has_value) {
+            executor_given = true;
+            if (!parse_executor_name(argv[++i], args.options.executor)) {
+                fprintf(stderr, "Unknown executor %s (use serial, openmp, pool, numa, steal or pipeline)\n", argv[i]);
+                return false;
+            }
+        } else if (arg == "--output" && has_value) {
+            args.output_path = argv[++i];
+        } else if (arg == "--output-format" && has_value) {
+            if (!parse_output_format(argv[++i], args.output_format)) {
+                fprintf(stderr, "Unknown output format %s (use bitmap or gaps)\n", argv[i]);
+                return false;
+            }
+        } else if (arg == "--cache" && has_value) {
+            args.cache_path = argv[++i];
+        } else if (arg == "--trace" && has_value) {
+            args.trace_path = argv[++i];
+        } else if (arg == "--stats") {
+            args.stats = true;
+        } else if (arg == "--checkpoint" && has_value) {
+            args.job.checkpoint_path = argv[++i];
+        } else if (arg == "--checkpoint-every" && has_value) {
+            args.job.checkpoint_interval_sec = atof(argv[++i]);
+        } else if (arg == "--deadline" && has_value) {
+            args.job.deadline_sec = atof(argv[++i]);
+        } else if (arg == "--progress" && has_value) {
+            args.job.progress_interval_sec = atof(argv[++i]);
+        } else if (arg == "--method" && has_value) {
+            std::string name = argv[++i];
+            if (name == "sieve") {
+                args.method = CountMethod::Sieve;
+            } else if (name == "lmo") {
+                args.method = CountMethod::Lmo;
+            } else {
+                fprintf(stderr, "Unknown method %s (use sieve or lmo)\n", argv[i]);
+                return false;
+            }
+        } else if (arg.rfind("--", 0) == 0) {
+            fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    // Positionals are assigned once we know whether --range supplied N
+    size_t next = 0;
+    if (!args.range && next < positional.size()) args.N = atoll(positional[next++]);
+    if (takes_threads && next < positional.size()) args.options.threads = atoi(positional[next++]);
+    if (next < positional.size()) {
+        fprintf(stderr, "Unexpected argument %s\n", positional[next]);
+        return false;
+    }
+
+    if ((args.print_primes ? 1 : 0) + (args.output_path.empty() ? 0 : 1) +
+            (args.cache_path.empty() ? 0 : 1) + (args.stats ? 1 : 0) > 1) {
+        fprintf(stderr, "--print, --output, --cache and --stats cannot be combined\n");
+        return false;
+    }
+
+    if (args.method == CountMethod::Lmo &&
+            (args.print_primes || !args.output_path.empty() || !args.cache_path.empty() || args.stats)) {
+        fprintf(stderr, "--method lmo only counts: it cannot be combined with --print, --output, --cache or --stats\n");
+        return false;
+    }
+
+    if (args.job_mode() && (args.print_primes || !args.output_path.empty() || !args.cache_path.empty() ||
+                            args.stats || args.method == CountMethod::Lmo)) {
+        fprintf(stderr, "--checkpoint, --deadline and --progress only count with the sieve: they cannot be "
+                        "combined with --print, --output, --cache, --stats or --method lmo\n");
+        return false;
+    }
+
+    // Jobs hand out their own checkpointed blocks (sieve_job.hpp), not the executor's runs
+    if (args.job_mode() && executor_given) {
+        fprintf(stderr, "--executor cannot be combined with --checkpoint, --deadline or --progress "
+                        "(jobs schedule their own blocks of segments)\n");
+        return false;
+    }
+
+    if (args.range && (args.A < 0 || args.A > args.N)) {
+        fprintf(stderr, "Bad range [%lld, %lld] (need 0 <= A <= B)\n", args.A, args.N);
+        return false;
+    }
+
+    WheelPattern wheel_check;
+    if (!wheel_check.build(args.options.wheel_modulus)) {
+        fprintf(stderr, "Unsupported wheel modulus %lld (use 2, 6, 30, 210, 2310, 30030 or 510510)\n",
+                args.options.wheel_modulus);
+        return false;
+    }
+    return true;
+}
+
+// Fill the trace's run parameters and write it, if --trace was given.
+// ctx is the default context when the run did not sieve.
+inline void finish_trace(SieveTrace& trace, const SieveArgs& args, const SieveContext& ctx,
+                         long long count, double elapsed) {
+    if (!trace.enabled()) return;
+    if (args.range) trace.add_param("A", args.A);
+    trace.add_param("N", args.N);
+    trace.add_param("threads", args.options.threads);
+    trace.add_param("count", count);
+    // Sieve geometry only if a context was built (not on a cache hit or with --method lmo)
+    if (ctx.segment_bytes > 0) {
+        trace.add_param("wheel", ctx.wheel.modulus);
+        trace.add_param("segment_bytes", ctx.segment_bytes);
+        trace.add_param("presieve_limit", ctx.wheel.largest_prime());
+    }
+    trace.add_param("simd_level", (long long)simd_kernels().level);  // 0 scalar, 1 avx2, 2 avx512
+    trace.add_phase("total_sec", elapsed);
+    if (!trace.write_json(args.trace_path)) {
+        fprintf(stderr, "Could not write trace file %s\n", args.trace_path.c_str());
+    }
+}
+
+// --checkpoint / --deadline / --progress: count ctx as a job. SIGINT and
+// SIGTERM stop it at the next segment and the checkpoint is still written.
+// Returns the prime count so far, or -1 on failure.
+inline long long run_job_from_args(SieveArgs& args, const SieveContext& ctx, SieveTrace& trace,
+                                   JobResult& result) {
+    install_job_signal_handlers();
+    args.job.cancel = &job_cancel_token();
+    if (!run_sieve_job(ctx, args.options, args.job, trace, result)) return -1;
+    return result.count;
+}
+
+// Build the context for [2, N], or for [A, B] in range mode
+inline bool build_context_from_args(const SieveArgs& args, SieveContext& ctx, SieveTrace& trace) {
+    return build_range_context(args.range ? args.A : 0, args.N, args.options, ctx, trace);
+}
+
+// Sieve ctx into the --output file. Returns the prime count, or -1 on failure.
+inline long long write_output_from_args(const SieveArgs& args, const SieveContext& ctx,
+                                        SieveTrace& trace) {
+    long long count = 0;
+    if (!write_sieve_file(ctx, args.options, trace, args.output_path, args.output_format, count)) {
+        fprintf(stderr, "Could not write output file %s\n", args.output_path.c_str());
+        return -1;
+    }
+    return count;
+}
+
+// --cache: count from the cache file if it covers the request.
+// Returns false (nothing counted) if there is no usable cache.
+inline bool count_from_cache(const SieveArgs& args, long long& count) {
+    if (args.cache_path.empty()) return false;
+    PrimeCache cache;
+    if (!cache.open(args.cache_path) || !cache.covers(args.N)) return false;
+    count = cache.count_range(args.range ? args.A : 0, args.N);
+    return true;
+}
+
+// --cache miss on a [2, N] run: sieve and save the result as the new cache.
+// Returns the prime count, or -1 on failure.
+inline long long write_cache_from_args(const SieveArgs& args, const SieveContext& ctx,
+                                       SieveTrace& trace) {
+    long long count = 0;
+    if (!write_prime_cache(ctx, args.options, trace, args.cache_path, count)) {
+        fprintf(stderr, "Could not write cache file %s\n", args.cache_path.c_str());
+        return -1;
+    }
+    return count;
+}
+
+// Whether this run should (re)build the cache: only [2, N] runs do, since
+// building from 2 for a narrow high range would cost far more than the range
+inline bool should_build_cache(const SieveArgs& args) {
+    return !args.cache_path.empty() && !args.range;
+}
+
+// Print 2 if the range holds it (the odd-only segments never do)
+inline void print_even_prime(const SieveContext& ctx) {
+    if (ctx.even_prime_count() > 0) printf("2\n");
+}
+
+// Print the surviving primes of the segment just sieved, in order
+inline void print_segment_primes(const SegmentBitset& segment) {
+    segment.for_each_set([](long long value) { printf("%lld\n", value); });
+}
+
+// Print one block from the streaming API (see sieve_stream.hpp)
+inline void print_prime_block(const long long* primes, size_t n) {
+    for (size_t i = 0; i < n; i++) printf("%lld\n", primes[i]);
+}
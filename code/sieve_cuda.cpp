@@ -0,0 +1,169 @@
+// ============================================================
+// sieve_cuda.cpp — CUDA Segmented Sieve driver
+// GPU version of the segmented sieve (kernels in sieve_cuda_kernels.cu)
+// PCAM: one thread block per segment, base primes and wheel pattern
+// uploaded once and shared read-only by every block
+// The host side is the shared engine's setup: build_range_context()
+// computes the base primes and the word-aligned wheel pattern; the GPU
+// only sieves segments (see sieve_cuda.hpp)
+// Usage: ./sieve_cuda <N> [cpu_threads] [--segment-bytes <B>] [--wheel <modulus>] [--trace <file.json>]
+//        ./sieve_cuda --range <A> <B> [cpu_threads] [--print] [...]   primes in [A, B] only
+// cpu_threads > 0 splits the segments between that many CPU workers and
+// the GPU, rebalanced from measured throughput (see sieve_hybrid.hpp)
+// --segment-bytes defaults to 32 KiB (at most 48 KiB of shared memory)
+// --print (GPU only) copies each batch's bitmaps back while the next batch runs
+// Output: N=<N> threads=<T> count=<count> time_sec=<time>
+//         A=<A> B=<B> threads=<T> count=<count> time_sec=<time>   (range mode)
+// ============================================================
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "sieve_engine.hpp"
+#include "sieve_cli.hpp"
+#include "sieve_cuda.hpp"
+#include "sieve_hybrid.hpp"
+
+using namespace std;
+using namespace chrono;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+// ------------------------------------------------------------
+// Step 1: Describe the context to the GPU as plain arrays
+// ------------------------------------------------------------
+CudaSieveInput make_cuda_input(const SieveContext& ctx) {
+    CudaSieveInput in;
+    in.first_value = ctx.first_value;
+    in.N = ctx.N;
+    in.seg_bits = ctx.seg_bits;
+    in.num_segments = ctx.num_segments;
+
+    // With an aligned wheel table the wheel primes are skipped; otherwise
+    // (wheel off, or 510510 whose table is too large) every odd prime is marked.
+    // The GPU has no pre-sieve, so primes above the wheel are always marked.
+    long long skip_upto = 2;
+    if (!ctx.wheel.aligned_words().empty()) {
+        in.wheel_words = ctx.wheel.aligned_words().data();
+        in.wheel_period_words = ctx.wheel.aligned_words().size();
+        in.wheel_shift = (int)ctx.wheel.aligned_shift;
+        in.wheel_primes = ctx.wheel.primes.data();
+        in.num_wheel_primes = (int)ctx.wheel.primes.size();
+        skip_upto = ctx.wheel.primes.back();
+    }
+    size_t first = 0;
+    while (first < ctx.base_primes.size() && (long long)ctx.base_primes[first] <= skip_upto) first++;
+    in.primes = ctx.base_primes.data() + first;
+    in.num_primes = ctx.base_primes.size() - first;
+    return in;
+}
+
+int main(int argc, char* argv[]) {
+    SieveArgs args;
+    args.N = 100000000LL;
+    args.options.segment_bytes = CUDA_SEGMENT_BYTES;
+    args.options.threads = 0;   // GPU only
+    if (!parse_sieve_args(argc, argv, true, args)) return 1;
+    if (args.options.threads < 0) args.options.threads = 0;
+    bool hybrid = args.options.threads > 0;
+    if (hybrid && args.print_primes) {
+        fprintf(stderr, "--print needs the GPU-only mode (no cpu_threads)\n");
+        return 1;
+    }
+    if (!args.output_path.empty() || !args.cache_path.empty() || args.method != CountMethod::Sieve ||
+            args.stats || args.job_mode()) {
+        fprintf(stderr, "--output, --cache, --method lmo, --stats and jobs (--checkpoint, --deadline, "
+                        "--progress) are not supported by sieve_cuda\n");
+        return 1;
+    }
+    if (args.options.segment_bytes > CUDA_MAX_SEGMENT_BYTES) {
+        fprintf(stderr, "--segment-bytes %lld is more than the %lld bytes of shared memory a block gets\n",
+                args.options.segment_bytes, CUDA_MAX_SEGMENT_BYTES);
+        return 1;
+    }
+    if (cuda_device_count() == 0) {
+        fprintf(stderr, "No CUDA device found\n");
+        return 1;
+    }
+
+    SieveTrace trace;
+    if (!args.trace_path.empty()) trace.enable(args.options.threads + 1);
+
+    auto t0 = high_resolution_clock::now();
+    SieveContext ctx;
+    build_context_from_args(args, ctx, trace);
+
+    if constexpr (VERBOSE) {
+        cout << "Segments = " << ctx.num_segments << " of " << ctx.segment_bytes << " bytes" << endl;
+        cout << "Base primes up to sqrt(N) = " << ctx.base_primes.size() << endl;
+    }
+
+    // --print: segments come back in order, so they can be printed directly
+    CudaSegmentSink sink;
+    SegmentBitset seg;
+    if (args.print_primes) {
+        print_even_prime(ctx);
+        sink = [&seg](long long, long long low, long long num_bits, const uint64_t* words) {
+            seg.prepare(low, num_bits);
+            for (size_t w = 0; w < seg.word_count(); w++) seg.words[w] = words[w];
+            print_segment_primes(seg);
+        };
+    }
+
+    double gpu_t0 = trace_now();
+    CudaSieve gpu;
+    string error;
+    if (!gpu.open(make_cuda_input(ctx), args.print_primes, error)) {
+        fprintf(stderr, "CUDA setup failed: %s\n", error.c_str());
+        return 1;
+    }
+
+    long long count = 0;
+    HybridStats split;
+    if (hybrid) {
+        count = run_hybrid(ctx, args.options.threads, gpu, trace, split, error);
+        if (!error.empty()) fprintf(stderr, "GPU failed, finished on the CPU: %s\n", error.c_str());
+        trace.add_param("cpu_segments", split.cpu_segments);
+        trace.add_param("gpu_segments", split.gpu_segments);
+        trace.add_param("gpu_chunks", split.gpu_chunks);
+    } else {
+        long long odd_count = gpu.sieve(0, ctx.num_segments, sink, error);
+        if (odd_count < 0) {
+            fprintf(stderr, "CUDA sieve failed: %s\n", error.c_str());
+            return 1;
+        }
+        count = ctx.even_prime_count() + odd_count;
+    }
+    const CudaSieveStats& stats = gpu.stats();
+    trace.add_phase("gpu_sec", trace_now() - gpu_t0);
+    trace.add_phase("gpu_kernel_sec", stats.kernel_sec);
+    trace.add_param("gpu_batches", stats.batches);
+    auto t1 = high_resolution_clock::now();
+
+    double elapsed = duration<double>(t1 - t0).count();
+
+    if constexpr (VERBOSE) {
+        cout << "Device = " << stats.device_name << ", batches = " << stats.batches
+             << ", kernel time = " << stats.kernel_sec << " s" << endl;
+        if (hybrid) {
+            cout << "Segments on CPU = " << split.cpu_segments << ", on GPU = " << split.gpu_segments
+                 << " (" << split.gpu_chunks << " chunks, last GPU share " << split.gpu_share << ")" << endl;
+        }
+    }
+
+    finish_trace(trace, args, ctx, count, elapsed);
+
+    if (args.range) {
+        printf("A=%lld B=%lld threads=%d count=%lld time_sec=%.6f\n",
+               args.A, args.N, args.options.threads, count, elapsed);
+    } else {
+        printf("N=%lld threads=%d count=%lld time_sec=%.6f\n",
+               args.N, args.options.threads, count, elapsed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+// ============================================================
+// sieve_cuda.hpp — Host interface of the CUDA segmented sieve
+// Implemented in sieve_cuda_kernels.cu, used by sieve_cuda.cpp
+// - The host builds the usual SieveContext (base primes, wheel, segment
+//   geometry) and hands the GPU plain arrays, so this header has no
+//   CUDA types and the engine headers never go through nvcc
+// - One thread block per segment; the segment lives in shared memory,
+//   starts as a copy of the word-aligned wheel pattern (multiples of
+//   3..13 already gone) and is marked by the block's threads, one base
+//   prime per thread at a time
+// - Segments are launched in batches that alternate between two CUDA
+//   streams: while one batch runs, the previous batch's counts (and,
+//   for enumeration, its bitmaps) are copied back and consumed
+// - No array of size N ever exists on the device, so N is bounded only
+//   by 64-bit arithmetic like the CPU drivers
+// ============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Default GPU segment: 32 KiB of bits, so two blocks fit in the shared
+// memory of one SM on most devices
+static const long long CUDA_SEGMENT_BYTES = 32 * 1024;
+
+// Shared memory a block may use without opting in to larger carve-outs
+static const long long CUDA_MAX_SEGMENT_BYTES = 48 * 1024;
+
+// Segments per kernel launch (and per host/device copy)
+static const long long CUDA_BATCH_SEGMENTS = 1024;
+
+// Threads per block
+static const int CUDA_BLOCK_THREADS = 256;
+
+// Everything the device needs, as plain arrays owned by the caller
+struct CudaSieveInput {
+    long long first_value = 3;   // segment s covers first_value + s * 2 * seg_bits ...
+    long long N = 0;             // ... up to N (inclusive)
+    long long seg_bits = 0;      // odd numbers per full segment (multiple of 64)
+    long long num_segments = 0;
+
+    const uint32_t* primes = nullptr;  // marking primes, increasing, none in the wheel
+    size_t num_primes = 0;
+
+    // Word-aligned wheel pattern (WheelPattern::aligned); null = start from all ones
+    const uint64_t* wheel_words = nullptr;
+    size_t wheel_period_words = 0;
+    int wheel_shift = 0;               // WheelPattern::aligned_shift
+    const int* wheel_primes = nullptr; // restored after the copy
+    int num_wheel_primes = 0;
+};
+
+// Called with each segment's bitset (bit i <-> low + 2*i), in segment order
+using CudaSegmentSink = std::function<void(long long seg_id, long long low, long long num_bits,
+                                           const uint64_t* words)>;
+
+// What the GPU run did, for the trace
+struct CudaSieveStats {
+    std::string device_name;
+    long long batches = 0;
+    double kernel_sec = 0;   // sum of kernel times (CUDA events)
+};
+
+// Number of CUDA devices that can run the sieve (0 = none or no driver)
+int cuda_device_count();
+
+// A sieve session on the current device: the base primes and wheel are
+// uploaded once by open(), then any number of segment ranges can be
+// sieved (the hybrid scheduler hands out ranges as it goes)
+class CudaSieve {
+public:
+    CudaSieve() = default;
+    ~CudaSieve() { close(); }
+    CudaSieve(const CudaSieve&) = delete;
+    CudaSieve& operator=(const CudaSieve&) = delete;
+
+    // Upload input's arrays and allocate the batch buffers (with bitmap
+    // buffers if keep_bitmaps). Returns false and fills error on failure.
+    bool open(const CudaSieveInput& input, bool keep_bitmaps, std::string& error);
+
+    // Sieve segments [seg_begin, seg_end) of the input and return the number
+    // of surviving odd primes (2 is not included). With a sink (needs
+    // keep_bitmaps), the segments are also passed to it in order. Returns -1
+    // and fills error on a CUDA failure.
+    long long sieve(long long seg_begin, long long seg_end, const CudaSegmentSink& sink,
+                    std::string& error);
+
+    const CudaSieveStats& stats() const { return stats_; }
+    void close();
+
+private:
+    struct Impl;               // CUDA buffers and streams (sieve_cuda_kernels.cu)
+    Impl* impl_ = nullptr;
+    CudaSieveStats stats_;
+};
+
+// Sieve every segment of input in one session (see CudaSieve::sieve)
+inline long long cuda_sieve(const CudaSieveInput& input, const CudaSegmentSink& sink,
+                            CudaSieveStats& stats, std::string& error) {
+    CudaSieve gpu;
+    if (!gpu.open(input, (bool)sink, error)) return -1;
+    long long count = gpu.sieve(0, input.num_segments, sink, error);
+    stats = gpu.stats();
+    return count;
+}
@@ -0,0 +1,351 @@
+// ============================================================
+// sieve_cuda_kernels.cu — CUDA segmented sieve (kernels and launcher)
+// Native counterpart of the notebook's Numba path. The Numba version
+// launches mark_multiples_for_prime_kernel once per prime over one array
+// of N bytes; here a single launch sieves a whole batch of segments:
+// - one thread block per segment (grid-stride if the batch has more
+//   segments than blocks), the segment's bits in shared memory
+// - step 1: copy the word-aligned wheel pattern (small primes as a
+//   bit pattern, no marking at all for 3..13)
+// - step 2: each thread takes every blockDim-th base prime and clears its
+//   odd multiples with shared-memory atomicAnd
+// - step 3: restore the wheel primes, mask the tail, popcount with __popc
+// - batches alternate between two streams, so the copy of one batch's
+//   results overlaps the next batch's kernel
+// See sieve_cuda.hpp for the host interface.
+// ============================================================
+
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sieve_cuda.hpp"
+
+// Kernel arguments passed by value (fits easily in the 4 KiB parameter space)
+struct CudaSegmentParams {
+    long long first_value;
+    long long N;
+    long long seg_bits;
+    long long first_segment;    // global id of the batch's first segment
+    long long batch_segments;
+    int words_per_segment;      // 32-bit words of a full segment
+
+    const uint32_t* primes;
+    long long num_primes;
+
+    const uint32_t* wheel;      // 2 * period 32-bit words, or null
+    long long wheel_words;      // number of 32-bit words in wheel
+    int wheel_shift;
+    int num_wheel_primes;
+    int wheel_primes[8];
+
+    unsigned long long* counts; // one per segment of the batch (zeroed)
+    uint32_t* bitmaps;          // words_per_segment per segment, or null
+};
+
+// ------------------------------------------------------------
+// Device kernel
+// ------------------------------------------------------------
+__global__ void sieve_segments_kernel(CudaSegmentParams p) {
+    extern __shared__ uint32_t seg[];
+
+    for (long long b = blockIdx.x; b < p.batch_segments; b += gridDim.x) {
+        long long s = p.first_segment + b;
+        long long seg_size = 2 * p.seg_bits;
+        long long low = p.first_value + s * seg_size;
+        long long high = (p.N - low < seg_size) ? p.N : low + seg_size - 1;
+        long long num_bits = (high - low) / 2 + 1;
+        int words = (int)((num_bits + 63) / 64) * 2;   // whole 64-bit words for the host
+
+        // Step 1: wheel pattern (or all ones). seg_bits is a multiple of 64,
+        // so every segment starts on a 64-bit word of the aligned pattern.
+        if (p.wheel != nullptr) {
+            long long k = (low - 1) / 2;
+            long long base = 2 * (((k - p.wheel_shift) / 64) % (p.wheel_words / 2));
+            for (int i = threadIdx.x; i < words; i += blockDim.x) {
+                seg[i] = p.wheel[(base + i) % p.wheel_words];
+            }
+        } else {
+            for (int i = threadIdx.x; i < words; i += blockDim.x) seg[i] = 0xFFFFFFFFu;
+        }
+        __syncthreads();
+
+        // Step 2: odd multiples of each base prime, from max(q^2, low).
+        // Primes are increasing, so a thread stops at its first q^2 > high.
+        for (long long i = threadIdx.x; i < p.num_primes; i += blockDim.x) {
+            long long q = p.primes[i];
+            if (q * q > high) break;
+
+            long long idx;
+            if (q * q >= low) {
+                idx = (q * q - low) / 2;
+            } else {
+                // Same overflow-safe form as first_odd_multiple_index()
+                long long offset = (q - low % q) % q;
+                if (offset % 2 != 0) offset += q;
+                idx = offset / 2;
+            }
+            for (; idx < num_bits; idx += q) {
+                atomicAnd(&seg[idx >> 5], ~(1u << (idx & 31)));
+            }
+        }
+        __syncthreads();
+
+        // Step 3: restore wheel primes that lie in this segment, clear the tail
+        if (threadIdx.x == 0) {
+            for (int j = 0; j < p.num_wheel_primes; j++) {
+                long long q = p.wheel_primes[j];
+                if (q >= low && q <= high) {
+                    long long i = (q - low) / 2;
+                    seg[i >> 5] |= 1u << (i & 31);
+                }
+            }
+            int w = (int)(num_bits >> 5);
+            int tail = (int)(num_bits & 31);
+            if (tail != 0) seg[w++] &= (1u << tail) - 1;
+            for (; w < words; w++) seg[w] = 0;
+        }
+        __syncthreads();
+
+        // Step 4: count (warp shuffle, then one atomic per warp) and copy out
+        unsigned int local = 0;
+        for (int i = threadIdx.x; i < words; i += blockDim.x) {
+            uint32_t v = seg[i];
+            local += __popc(v);
+            if (p.bitmaps != nullptr) p.bitmaps[b * p.words_per_segment + i] = v;
+        }
+        for (int delta = 16; delta > 0; delta /= 2) {
+            local += __shfl_down_sync(0xFFFFFFFFu, local, delta);
+        }
+        if ((threadIdx.x & 31) == 0 && local != 0) atomicAdd(&p.counts[b], (unsigned long long)local);
+
+        // The next segment overwrites seg
+        __syncthreads();
+    }
+}
+
+// ------------------------------------------------------------
+// Host side
+// ------------------------------------------------------------
+
+// Records the first CUDA error; results of later calls are ignored
+struct CudaCheck {
+    std::string& error;
+
+    bool operator()(cudaError_t e, const char* what) {
+        if (!error.empty()) return false;
+        if (e == cudaSuccess) return true;
+        error = std::string(what) + ": " + cudaGetErrorString(e);
+        return false;
+    }
+};
+
+// Device and pinned host buffers for one in-flight batch
+struct CudaBatchSlot {
+    cudaStream_t stream = nullptr;
+    cudaEvent_t start = nullptr;
+    cudaEvent_t stop = nullptr;
+    unsigned long long* d_counts = nullptr;
+    uint32_t* d_bitmaps = nullptr;
+    unsigned long long* h_counts = nullptr;
+    uint32_t* h_bitmaps = nullptr;
+    long long first_segment = 0;
+    long long segments = 0;      // 0 = slot idle
+};
+
+struct CudaSieve::Impl {
+    CudaSieveInput input;
+    CudaSegmentParams params = {};
+    uint32_t* d_primes = nullptr;
+    uint32_t* d_wheel = nullptr;
+    CudaBatchSlot slots[2];      // batch b uses slot b % 2
+    size_t count_bytes = 0;
+    size_t shared_bytes = 0;
+    int grid = 1;
+};
+
+int cuda_device_count() {
+    int n = 0;
+    if (cudaGetDeviceCount(&n) != cudaSuccess) return 0;
+    return n;
+}
+
+bool CudaSieve::open(const CudaSieveInput& input, bool keep_bitmaps, std::string& error) {
+    close();
+    error.clear();
+    if (input.seg_bits <= 0 || input.seg_bits % 64 != 0 || input.seg_bits / 8 > CUDA_MAX_SEGMENT_BYTES) {
+        error = "segment size must be a multiple of 8 bytes and at most 48 KiB";
+        return false;
+    }
+    if (input.num_wheel_primes > 8) {
+        error = "wheel has too many primes for the kernel";
+        return false;
+    }
+    CudaCheck check{error};
+
+    int device = 0;
+    cudaDeviceProp prop;
+    if (!check(cudaGetDevice(&device), "cudaGetDevice")) return false;
+    if (!check(cudaGetDeviceProperties(&prop, device), "cudaGetDeviceProperties")) return false;
+    stats_ = CudaSieveStats();
+    stats_.device_name = prop.name;
+
+    impl_ = new Impl();
+    Impl& g = *impl_;
+    g.input = input;
+
+    // Read-only inputs, uploaded once
+    size_t prime_bytes = std::max<size_t>(1, input.num_primes) * sizeof(uint32_t);
+    check(cudaMalloc(&g.d_primes, prime_bytes), "cudaMalloc(primes)");
+    if (input.num_primes > 0) {
+        check(cudaMemcpy(g.d_primes, input.primes, input.num_primes * sizeof(uint32_t),
+                         cudaMemcpyHostToDevice), "cudaMemcpy(primes)");
+    }
+    if (input.wheel_words != nullptr) {
+        // A 64-bit word is two 32-bit words, low half first (little endian)
+        size_t wheel_bytes = input.wheel_period_words * sizeof(uint64_t);
+        check(cudaMalloc(&g.d_wheel, wheel_bytes), "cudaMalloc(wheel)");
+        check(cudaMemcpy(g.d_wheel, input.wheel_words, wheel_bytes, cudaMemcpyHostToDevice),
+              "cudaMemcpy(wheel)");
+    }
+
+    CudaSegmentParams& params = g.params;
+    params.first_value = input.first_value;
+    params.N = input.N;
+    params.seg_bits = input.seg_bits;
+    params.words_per_segment = (int)(input.seg_bits / 32);
+    params.primes = g.d_primes;
+    params.num_primes = (long long)input.num_primes;
+    params.wheel = g.d_wheel;
+    params.wheel_words = (long long)input.wheel_period_words * 2;
+    params.wheel_shift = input.wheel_shift;
+    params.num_wheel_primes = input.num_wheel_primes;
+    for (int j = 0; j < input.num_wheel_primes; j++) params.wheel_primes[j] = input.wheel_primes[j];
+
+    g.count_bytes = (size_t)CUDA_BATCH_SEGMENTS * sizeof(unsigned long long);
+    g.shared_bytes = (size_t)params.words_per_segment * sizeof(uint32_t);
+    size_t bitmap_bytes = (size_t)CUDA_BATCH_SEGMENTS * g.shared_bytes;
+    for (CudaBatchSlot& slot : g.slots) {
+        check(cudaStreamCreateWithFlags(&slot.stream, cudaStreamNonBlocking), "cudaStreamCreate");
+        check(cudaEventCreate(&slot.start), "cudaEventCreate");
+        check(cudaEventCreate(&slot.stop), "cudaEventCreate");
+        check(cudaMalloc(&slot.d_counts, g.count_bytes), "cudaMalloc(counts)");
+        check(cudaMallocHost(&slot.h_counts, g.count_bytes), "cudaMallocHost(counts)");
+        if (keep_bitmaps) {
+            check(cudaMalloc(&slot.d_bitmaps, bitmap_bytes), "cudaMalloc(bitmaps)");
+            check(cudaMallocHost(&slot.h_bitmaps, bitmap_bytes), "cudaMallocHost(bitmaps)");
+        }
+    }
+
+    // A few blocks per SM hide the atomics' latency
+    g.grid = (int)std::min<long long>(CUDA_BATCH_SEGMENTS, (long long)prop.multiProcessorCount * 8);
+
+    if (!error.empty()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+long long CudaSieve::sieve(long long seg_begin, long long seg_end, const CudaSegmentSink& sink,
+                           std::string& error) {
+    error.clear();
+    if (impl_ == nullptr) {
+        error = "CUDA sieve is not open";
+        return -1;
+    }
+    Impl& g = *impl_;
+    const CudaSieveInput& input = g.input;
+    if (sink && g.slots[0].d_bitmaps == nullptr) {
+        error = "CUDA sieve was opened without bitmap buffers";
+        return -1;
+    }
+    seg_end = std::min(seg_end, input.num_segments);
+    if (seg_begin >= seg_end) return 0;
+    CudaCheck check{error};
+
+    long long total = 0;
+    long long seg_size = 2 * input.seg_bits;
+
+    // Wait for a slot's batch, then add up its counts and feed the sink
+    auto consume = [&](CudaBatchSlot& slot) {
+        if (slot.segments == 0 || !error.empty()) return;
+        if (!check(cudaStreamSynchronize(slot.stream), "sieve batch")) return;
+        float ms = 0;
+        if (cudaEventElapsedTime(&ms, slot.start, slot.stop) == cudaSuccess) stats_.kernel_sec += ms / 1000.0;
+
+        for (long long b = 0; b < slot.segments; b++) {
+            total += (long long)slot.h_counts[b];
+            if (sink) {
+                long long s = slot.first_segment + b;
+                long long low = input.first_value + s * seg_size;
+                long long high = (input.N - low < seg_size) ? input.N : low + seg_size - 1;
+                const uint32_t* words = slot.h_bitmaps + b * g.params.words_per_segment;
+                sink(s, low, (high - low) / 2 + 1, reinterpret_cast<const uint64_t*>(words));
+            }
+        }
+        slot.segments = 0;
+    };
+
+    long long launched = 0;
+    for (long long first = seg_begin; first < seg_end && error.empty(); first += CUDA_BATCH_SEGMENTS) {
+        CudaBatchSlot& slot = g.slots[launched % 2];
+        consume(slot);   // results of batch launched - 2
+        if (!error.empty()) break;
+
+        slot.first_segment = first;
+        slot.segments = std::min(CUDA_BATCH_SEGMENTS, seg_end - first);
+
+        CudaSegmentParams launch = g.params;
+        launch.first_segment = first;
+        launch.batch_segments = slot.segments;
+        launch.counts = slot.d_counts;
+        launch.bitmaps = sink ? slot.d_bitmaps : nullptr;
+        int grid = (int)std::min<long long>(g.grid, slot.segments);
+
+        check(cudaMemsetAsync(slot.d_counts, 0, (size_t)slot.segments * sizeof(unsigned long long),
+                              slot.stream), "cudaMemsetAsync");
+        check(cudaEventRecord(slot.start, slot.stream), "cudaEventRecord");
+        sieve_segments_kernel<<<grid, CUDA_BLOCK_THREADS, g.shared_bytes, slot.stream>>>(launch);
+        check(cudaGetLastError(), "sieve_segments_kernel launch");
+        check(cudaEventRecord(slot.stop, slot.stream), "cudaEventRecord");
+        check(cudaMemcpyAsync(slot.h_counts, slot.d_counts, (size_t)slot.segments * sizeof(unsigned long long),
+                              cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync(counts)");
+        if (sink) {
+            check(cudaMemcpyAsync(slot.h_bitmaps, slot.d_bitmaps, (size_t)slot.segments * g.shared_bytes,
+                                  cudaMemcpyDeviceToHost, slot.stream), "cudaMemcpyAsync(bitmaps)");
+        }
+        launched++;
+    }
+    stats_.batches += launched;
+
+    // Drain the last two batches in order (batch launched-2 sits in slot launched % 2)
+    consume(g.slots[launched % 2]);
+    consume(g.slots[(launched + 1) % 2]);
+
+    // After an error, forget whatever is still in flight
+    for (CudaBatchSlot& slot : g.slots) slot.segments = 0;
+    return error.empty() ? total : -1;
+}
+
+void CudaSieve::close() {
+    if (impl_ == nullptr) return;
+    Impl& g = *impl_;
+    for (CudaBatchSlot& slot : g.slots) {
+        if (slot.stream) cudaStreamSynchronize(slot.stream);
+        if (slot.h_bitmaps) cudaFreeHost(slot.h_bitmaps);
+        if (slot.d_bitmaps) cudaFree(slot.d_bitmaps);
+        if (slot.h_counts) cudaFreeHost(slot.h_counts);
+        if (slot.d_counts) cudaFree(slot.d_counts);
+        if (slot.stop) cudaEventDestroy(slot.stop);
+        if (slot.start) cudaEventDestroy(slot.start);
+        if (slot.stream) cudaStreamDestroy(slot.stream);
+    }
+    if (g.d_wheel) cudaFree(g.d_wheel);
+    if (g.d_primes) cudaFree(g.d_primes);
+    delete impl_;
+    impl_ = nullptr;
+}
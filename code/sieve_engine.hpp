@@ -0,0 +1,237 @@
+// ============================================================
+// sieve_engine.hpp — Shared segmented sieve engine (libsieve)
+// Used by every driver (sieve_serial.cpp, sieve_openmp.cpp, ...)
+// - Base primes up to sqrt(N), generated once for everyone
+//   (segmented and parallel for large N, see sieve_base_primes.hpp)
+// - SieveContext: read-only setup shared by all workers
+//   (base primes, wheel, segment geometry, prime class boundaries)
+// - The segment kernel: begin_run() + sieve_segment() on a worker's
+//   SieveThreadState. Every executor (see sieve_executors.hpp) calls
+//   exactly this code, so an optimization here lands everywhere.
+// Segment s covers the odd numbers first_value + seg_size*s ... up to
+// min(that + seg_size - 1, N); bit i of the bitset is low + 2*i.
+// A range run [A, B] (build_range_context) only moves first_value up to
+// the first odd number >= A: base primes still go up to sqrt(B), but no
+// segment below A is ever sieved.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "sieve_bitset.hpp"
+#include "sieve_base_primes.hpp"
+#include "sieve_wheel.hpp"
+#include "sieve_buckets.hpp"
+#include "sieve_offsets.hpp"
+#include "sieve_arena.hpp"
+#include "sieve_cache.hpp"
+#include "sieve_trace.hpp"
+
+// Default wheel: 2*3*5*7*11*13 (pattern removes multiples of 3..13)
+static const long long DEFAULT_WHEEL = 30030;
+
+// Pre-sieve: DEFAULT_PRESIEVE_LIMIT (primes 17..127 ANDed in as patterns)
+// and its cap MAX_PRESIEVE_LIMIT are defined with the patterns in sieve_wheel.hpp
+
+// Upper bound on consecutive segments handed to one worker at a time
+static const long long MAX_RUN_SEGMENTS = 64;
+
+enum class SieveExecutor { Serial, OpenMP, ThreadPool, Numa, WorkStealing, Pipeline };
+
+struct SieveOptions {
+    long long wheel_modulus = DEFAULT_WHEEL;
+    long long segment_bytes = 0;   // 0 = pick from the detected cache sizes
+    int threads = 1;
+    SieveExecutor executor = SieveExecutor::Serial;
+    long long max_run_segments = MAX_RUN_SEGMENTS;  // cap on segments per run
+    int presieve_limit = DEFAULT_PRESIEVE_LIMIT;    // 0 = wheel pattern only
+};
+
+// ------------------------------------------------------------
+// Read-only state shared by all workers of one sieve run
+// ------------------------------------------------------------
+struct SieveContext {
+    long long N = 0;               // upper end of the range (inclusive)
+    long long A = 0;               // lower end of the range (0 = from 2)
+    long long first_value = 3;     // segments cover the odd numbers in [first_value..N]
+    long long segment_bytes = 0;
+    long long seg_bits = 0;        // odd numbers per full segment
+    long long seg_size = 0;        // numbers per full segment (2 * seg_bits)
+    long long num_segments = 0;
+
+    std::vector<uint32_t> base_primes;  // all primes <= sqrt(N) (< 2^32 for any N < 2^63)
+    WheelPattern wheel;
+    size_t first_marking_prime = 0;  // first prime not folded into the wheel
+    size_t first_large = 0;          // first prime handled by buckets
+
+    long long segment_low(long long s) const { return first_value + s * seg_size; }
+
+    // Written as a difference so N close to 2^63 cannot overflow
+    long long segment_high(long long s) const {
+        long long low = segment_low(s);
+        return (N - low < seg_size) ? N : low + seg_size - 1;
+    }
+
+    long long segment_num_bits(long long s) const {
+        return (segment_high(s) - segment_low(s)) / 2 + 1;
+    }
+
+    // Count contributed by the prime 2, which the odd-only segments never see
+    long long even_prime_count() const { return (A <= 2 && N >= 2) ? 1 : 0; }
+};
+
+// Geometry and wheel of the context for the primes in [A, B], without the
+// base primes (see set_base_primes). Returns false if the wheel modulus is
+// unsupported.
+inline bool prepare_range_context(long long A, long long B, const SieveOptions& options,
+                                  SieveContext& ctx) {
+    long long N = B;
+    ctx.N = N;
+    ctx.A = A;
+    if (!ctx.wheel.build(options.wheel_modulus)) return false;
+
+    // First odd number >= max(A, 3); 2 is counted by even_prime_count()
+    ctx.first_value = std::max(A, 3LL);
+    if (ctx.first_value % 2 == 0) ctx.first_value++;
+
+    // Every segment starts at bit (first_value-1)/2 + s * seg_bits, and seg_bits
+    // is a multiple of 64, so one aligned table layout fits all of them
+    ctx.wheel.align((int)(((ctx.first_value - 1) / 2) % 64), options.presieve_limit);
+
+    ctx.segment_bytes = options.segment_bytes > 0
+                            ? normalize_segment_bytes(options.segment_bytes)
+                            : default_segment_bytes(detect_cache_info());
+    ctx.seg_bits = ctx.segment_bytes * 8;
+    ctx.seg_size = ctx.seg_bits * 2;
+    ctx.num_segments = (N >= ctx.first_value) ? (N - ctx.first_value) / ctx.seg_size + 1 : 0;
+    return true;
+}
+
+// Install the base primes: every prime <= sqrt(N), in increasing order (a list
+// that runs further is fine, e.g. one shared by several slices of a range)
+inline void set_base_primes(SieveContext& ctx, std::vector<uint32_t> primes) {
+    ctx.base_primes = std::move(primes);
+
+    // Base primes folded into the wheel are skipped by the marking loop
+    ctx.first_marking_prime = 0;
+    while (ctx.first_marking_prime < ctx.base_primes.size() &&
+           (long long)ctx.base_primes[ctx.first_marking_prime] <= ctx.wheel.largest_prime()) {
+        ctx.first_marking_prime++;
+    }
+
+    // Primes with step >= segment length hit a segment at most once;
+    // they are handled through buckets instead of the per-segment loop
+    ctx.first_large = std::max(ctx.first_marking_prime,
+                               first_large_prime_index(ctx.base_primes, ctx.seg_bits));
+}
+
+// Build the shared context for the primes in [A, B].
+// Returns false if the wheel modulus is unsupported.
+inline bool build_range_context(long long A, long long B, const SieveOptions& options,
+                                SieveContext& ctx, SieveTrace& trace) {
+    if (!prepare_range_context(A, B, options, ctx)) return false;
+
+    double phase_t0 = trace_now();
+    std::vector<uint32_t> primes = generate_base_primes(integer_sqrt(B), options.threads);
+    trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+
+    set_base_primes(ctx, std::move(primes));
+    return true;
+}
+
+// Build the shared context for the primes in [2, N]
+inline bool build_sieve_context(long long N, const SieveOptions& options,
+                                SieveContext& ctx, SieveTrace& trace) {
+    return build_range_context(0, N, options, ctx, trace);
+}
+
+// ------------------------------------------------------------
+// The segment kernel
+// ------------------------------------------------------------
+struct SegmentResult {
+    long long seg_id = 0;
+    long long low = 0;        // first odd number in the segment
+    long long num_bits = 0;   // odd numbers in the segment
+    long long primes = 0;     // survivors (primes) in the segment
+    long long marks = 0;      // bits cleared by small-prime and bucket marking
+};
+
+// Segments are handed out in contiguous runs so each run can keep its own
+// buckets and offsets. Aim for ~8 runs per worker for dynamic load balancing.
+// Runs are handed out in increasing order (ordered consumers rely on this).
+inline long long plan_run_length(const SieveContext& ctx, int num_workers,
+                                 long long max_run = MAX_RUN_SEGMENTS) {
+    long long workers = num_workers > 0 ? num_workers : 1;
+    return std::min(std::max(1LL, max_run), std::max(1LL, ctx.num_segments / (8LL * workers)));
+}
+
+// Prepare a worker for the contiguous run of segments [seg_begin, seg_end).
+// One division per base prime here; nothing per segment afterwards.
+inline void begin_run(SieveThreadState& state, const SieveContext& ctx,
+                      long long seg_begin, long long seg_end) {
+    state.buckets.init(ctx.base_primes, ctx.first_large, ctx.first_value, ctx.seg_bits,
+                       seg_begin, seg_end);
+    state.offsets.init(ctx.base_primes, ctx.first_marking_prime, ctx.first_large,
+                       ctx.segment_low(seg_begin));
+}
+
+// Sieve segment seg_id into state.segment. Within a run, segments must be
+// sieved in increasing order without gaps (offsets and buckets carry forward).
+inline SegmentResult sieve_segment(SieveThreadState& state, const SieveContext& ctx,
+                                   long long seg_id) {
+    SegmentResult r;
+    r.seg_id = seg_id;
+    r.low = ctx.segment_low(seg_id);
+    r.num_bits = ctx.segment_num_bits(seg_id);
+
+    // Multiples of the wheel primes are already 0 after this copy
+    state.wheel.fill(state.segment, r.low, r.num_bits);
+
+    // Small/medium primes continue from where the previous segment stopped;
+    // large primes only touch the segment if it holds one of their multiples
+    r.marks = state.offsets.sieve_segment(state.segment);
+    r.marks += state.buckets.sieve_segment(state.segment, seg_id);
+
+    // Tail word is masked, so survivors are a plain popcount
+    r.primes = state.segment.count();
+    return r;
+}
+
+// Visitor that ignores every segment (count-only runs)
+struct NoSegmentVisitor {
+    void operator()(int, const SieveThreadState&, const SegmentResult&) const {}
+};
+
+// Sieve the next segment s of the current run, update the worker's trace
+// and call visit(tid, state, result). Returns the segment's prime count.
+template <typename Visitor>
+long long sieve_traced_segment(SieveThreadState& state, const SieveContext& ctx, long long s,
+                               int tid, ThreadTrace* tt, Visitor& visit) {
+    double seg_t0 = tt ? trace_now() : 0.0;
+    SegmentResult r = sieve_segment(state, ctx, s);
+    if (tt) tt->record_segment(trace_now() - seg_t0, r.marks, r.primes);
+
+    visit(tid, state, r);
+    return r.primes;
+}
+
+// Sieve the run [seg_begin, seg_end) on one worker, updating its trace and
+// calling visit(tid, state, result) after each segment. Returns the prime count.
+template <typename Visitor>
+long long sieve_run(SieveThreadState& state, const SieveContext& ctx,
+                    long long seg_begin, long long seg_end,
+                    int tid, ThreadTrace* tt, Visitor& visit) {
+    begin_run(state, ctx, seg_begin, seg_end);
+    if (tt) tt->runs++;
+
+    long long count = 0;
+    for (long long s = seg_begin; s < seg_end; s++) {
+        count += sieve_traced_segment(state, ctx, s, tid, tt, visit);
+    }
+    return count;
+}
@@ -0,0 +1,418 @@
+// ============================================================
+// sieve_executors.hpp — Pluggable executors for the shared engine
+// - run_serial():      one worker, one run covering every segment
+// - run_openmp():      OpenMP team, runs handed out with schedule(dynamic)
+// - run_thread_pool(): std::thread workers pulling runs from an atomic
+//                      counter (no OpenMP runtime needed)
+// - run_numa():        pinned std::thread workers, one context replica
+//                      per NUMA node, segment range split by node
+// - run_work_stealing(): every worker starts with one contiguous block and
+//                      steals the back half of the largest remaining
+//                      block when its own runs out
+// - run_pipelined():   sieve workers hand finished bitmaps to a consumer
+//                      thread through recycled buffers (sieve_pipeline.hpp)
+// - parallel_items(): the same OpenMP / atomic-counter scheduling for
+//                      work that is not a sieve segment (e.g. blocks of
+//                      moduli, combinatorial pi(x) segments)
+// All of them call the same kernel (sieve_run in sieve_engine.hpp), so
+// benchmarks compare scheduling, not two copies of the sieve.
+// The visitor is called as visit(tid, state, result) after every
+// segment; with the parallel executors it runs concurrently on the
+// worker threads and must synchronize itself (except with the pipeline,
+// which calls it in segment order on one consumer thread).
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "sieve_engine.hpp"
+#include "sieve_numa.hpp"
+#include "sieve_pipeline.hpp"
+
+template <typename Visitor>
+long long run_serial(const SieveContext& ctx, SieveTrace& trace, Visitor&& visit) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+
+    ThreadTrace* tt = trace.thread(0);
+    double region_t0 = tt ? trace_now() : 0.0;
+
+    SieveThreadState state;
+    state.init(ctx.wheel, ctx.seg_bits);
+    total += sieve_run(state, ctx, 0, ctx.num_segments, 0, tt, visit);
+
+    if (tt) tt->region_sec = trace_now() - region_t0;
+    return total;
+}
+
+template <typename Visitor>
+long long run_thread_pool(const SieveContext& ctx, int num_threads, SieveTrace& trace,
+                          Visitor&& visit, long long max_run = MAX_RUN_SEGMENTS) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (num_threads < 1) num_threads = 1;
+
+    long long run_length = plan_run_length(ctx, num_threads, max_run);
+    long long num_runs = (ctx.num_segments + run_length - 1) / run_length;
+
+    std::atomic<long long> next_run(0);
+    std::vector<long long> counts((size_t)num_threads, 0);
+
+    auto worker = [&](int tid) {
+        ThreadTrace* tt = trace.thread(tid);
+        double region_t0 = tt ? trace_now() : 0.0;
+
+        // Buffers created by the thread that uses them (first touch)
+        SieveThreadState state;
+        state.init(ctx.wheel, ctx.seg_bits);
+
+        long long local = 0;
+        for (;;) {
+            long long run_id = next_run.fetch_add(1, std::memory_order_relaxed);
+            if (run_id >= num_runs) break;
+            long long run_begin = run_id * run_length;
+            long long run_end = std::min(run_begin + run_length, ctx.num_segments);
+            local += sieve_run(state, ctx, run_begin, run_end, tid, tt, visit);
+        }
+        counts[(size_t)tid] = local;
+
+        if (tt) tt->region_sec = trace_now() - region_t0;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < num_threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+
+    for (long long c : counts) total += c;
+    return total;
+}
+
+template <typename Visitor>
+long long run_openmp(const SieveContext& ctx, int num_threads, SieveTrace& trace,
+                     Visitor&& visit, long long max_run = MAX_RUN_SEGMENTS) {
+#ifdef _OPENMP
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (num_threads < 1) num_threads = 1;
+
+    long long run_length = plan_run_length(ctx, num_threads, max_run);
+    long long num_runs = (ctx.num_segments + run_length - 1) / run_length;
+    long long odd_count = 0;
+
+    // One parallel region: each thread sets up its arena once, then
+    // runs of consecutive segments are shared out with dynamic scheduling
+    // (monotonic: runs start in increasing order, like the thread pool)
+    #pragma omp parallel num_threads(num_threads) reduction(+:odd_count)
+    {
+        int tid = omp_get_thread_num();
+        ThreadTrace* tt = trace.thread(tid);
+        double region_t0 = tt ? trace_now() : 0.0;
+
+        SieveThreadState state;
+        state.init(ctx.wheel, ctx.seg_bits);
+
+        #pragma omp for schedule(monotonic:dynamic)
+        for (long long run_id = 0; run_id < num_runs; run_id++) {
+            long long run_begin = run_id * run_length;
+            long long run_end = std::min(run_begin + run_length, ctx.num_segments);
+            odd_count += sieve_run(state, ctx, run_begin, run_end, tid, tt, visit);
+        }
+
+        // Includes the wait at the implicit barrier of the omp for
+        if (tt) tt->region_sec = trace_now() - region_t0;
+    }
+    return total + odd_count;
+#else
+    // Built without OpenMP: same scheduling with plain threads
+    return run_thread_pool(ctx, num_threads, trace, visit, max_run);
+#endif
+}
+
+// Per-node share of the segment range, on its own cache line
+struct alignas(CACHE_LINE_BYTES) NodeWork {
+    std::atomic<long long> next_run{0};
+    long long seg_begin = 0;
+    long long num_runs = 0;
+};
+
+// NUMA-aware executor:
+// - threads are spread over the nodes and pinned (see sieve_numa.hpp)
+// - each node gets its own copy of the context (base primes, wheel),
+//   written by a thread pinned on that node, so it is node-local
+// - the segment range is split into one contiguous block per node, in
+//   proportion to the node's threads; threads take runs from their own
+//   node first and only then help other nodes (runs still start in
+//   increasing order within each node)
+template <typename Visitor>
+long long run_numa(const SieveContext& ctx, int num_threads, SieveTrace& trace,
+                   Visitor&& visit, long long max_run = MAX_RUN_SEGMENTS) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (num_threads < 1) num_threads = 1;
+
+    NumaTopology topo = detect_numa_topology();
+    std::vector<ThreadPlacement> placement = plan_thread_placement(topo, num_threads);
+    int num_nodes = (int)topo.nodes.size();
+
+    // Node replicas, each first-touched by a thread pinned on its node
+    std::vector<SieveContext> replicas((size_t)num_nodes);
+    {
+        std::vector<std::thread> copiers;
+        for (int n = 0; n < num_nodes; n++) {
+            copiers.emplace_back([&, n]() {
+                if (!topo.nodes[(size_t)n].cpus.empty()) pin_current_thread(topo.nodes[(size_t)n].cpus[0]);
+                replicas[(size_t)n] = ctx;
+                replicas[(size_t)n].wheel.own_tables();   // node-local pre-sieve tables too
+            });
+        }
+        for (std::thread& th : copiers) th.join();
+    }
+
+    // Split the segments by node in proportion to each node's threads
+    long long run_length = plan_run_length(ctx, num_threads, max_run);
+    std::vector<long long> node_threads((size_t)num_nodes, 0);
+    for (const ThreadPlacement& p : placement) node_threads[(size_t)p.node_index]++;
+
+    std::vector<NodeWork> work((size_t)num_nodes);
+    long long seg_begin = 0, threads_before = 0;
+    for (int n = 0; n < num_nodes; n++) {
+        threads_before += node_threads[(size_t)n];
+        long long seg_end = ctx.num_segments * threads_before / num_threads;
+        work[(size_t)n].seg_begin = seg_begin;
+        work[(size_t)n].num_runs = (seg_end - seg_begin + run_length - 1) / run_length;
+        seg_begin = seg_end;
+    }
+    std::vector<long long> node_end((size_t)num_nodes);
+    for (int n = 0; n < num_nodes; n++) {
+        node_end[(size_t)n] = (n + 1 < num_nodes) ? work[(size_t)n + 1].seg_begin : ctx.num_segments;
+    }
+
+    std::vector<long long> counts((size_t)num_threads, 0);
+
+    auto worker = [&](int tid) {
+        const ThreadPlacement& place = placement[(size_t)tid];
+        pin_current_thread(place.cpu);
+        const SieveContext& local_ctx = replicas[(size_t)place.node_index];
+
+        ThreadTrace* tt = trace.thread(tid);
+        if (tt) {
+            tt->node = topo.nodes[(size_t)place.node_index].id;
+            tt->cpu = place.cpu;
+        }
+        double region_t0 = tt ? trace_now() : 0.0;
+
+        // Pinned before this, so the arena is allocated on the thread's node
+        SieveThreadState state;
+        state.init(local_ctx.wheel, local_ctx.seg_bits);
+
+        long long local = 0;
+        for (int k = 0; k < num_nodes; k++) {
+            int n = (place.node_index + k) % num_nodes;
+            NodeWork& w = work[(size_t)n];
+            for (;;) {
+                long long run_id = w.next_run.fetch_add(1, std::memory_order_relaxed);
+                if (run_id >= w.num_runs) break;
+                long long run_begin = w.seg_begin + run_id * run_length;
+                long long run_end = std::min(run_begin + run_length, node_end[(size_t)n]);
+                local += sieve_run(state, local_ctx, run_begin, run_end, tid, tt, visit);
+            }
+        }
+        counts[(size_t)tid] = local;
+
+        if (tt) tt->region_sec = trace_now() - region_t0;
+    };
+
+    // All workers are new threads, so the caller's own affinity is untouched
+    std::vector<std::thread> pool;
+    for (int t = 0; t < num_threads; t++) pool.emplace_back(worker, t);
+    for (std::thread& th : pool) th.join();
+
+    for (long long c : counts) total += c;
+    return total;
+}
+
+// One worker's remaining block [front, back). The owner pops from the
+// front, thieves cut off the back; both under the lock. front/back are
+// atomics only so other workers can peek at the size without locking.
+struct alignas(CACHE_LINE_BYTES) StealableRange {
+    std::mutex lock;
+    std::atomic<long long> front{0};
+    std::atomic<long long> back{0};
+
+    long long remaining() const {
+        return back.load(std::memory_order_relaxed) - front.load(std::memory_order_relaxed);
+    }
+
+    // Owner: take the next segment, or -1 if the block is empty
+    long long pop_front() {
+        std::lock_guard<std::mutex> guard(lock);
+        long long f = front.load(std::memory_order_relaxed);
+        if (f >= back.load(std::memory_order_relaxed)) return -1;
+        front.store(f + 1, std::memory_order_relaxed);
+        return f;
+    }
+
+    // Thief: cut off the back half (rounded up). Returns false if empty.
+    bool steal_back_half(long long& out_begin, long long& out_end) {
+        std::lock_guard<std::mutex> guard(lock);
+        long long f = front.load(std::memory_order_relaxed);
+        long long b = back.load(std::memory_order_relaxed);
+        if (f >= b) return false;
+        long long mid = f + (b - f) / 2;
+        back.store(mid, std::memory_order_relaxed);
+        out_begin = mid;
+        out_end = b;
+        return true;
+    }
+
+    // Owner: install a freshly stolen block
+    void reset(long long begin, long long end) {
+        std::lock_guard<std::mutex> guard(lock);
+        front.store(begin, std::memory_order_relaxed);
+        back.store(end, std::memory_order_relaxed);
+    }
+};
+
+// Work-stealing executor. Worker t starts with the t-th contiguous slice of
+// the segments and sieves it front to back as one run, so offsets and
+// buckets carry forward segment after segment with no shared counter.
+// An idle worker steals the back half of the largest remaining block; the
+// victim keeps its run going on the front half, the thief starts a new run.
+template <typename Visitor>
+long long run_work_stealing(const SieveContext& ctx, int num_threads, SieveTrace& trace,
+                            Visitor&& visit) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (num_threads < 1) num_threads = 1;
+
+    std::vector<StealableRange> ranges((size_t)num_threads);
+    for (int t = 0; t < num_threads; t++) {
+        ranges[(size_t)t].front = ctx.num_segments * t / num_threads;
+        ranges[(size_t)t].back = ctx.num_segments * (t + 1) / num_threads;
+    }
+    std::vector<long long> counts((size_t)num_threads, 0);
+
+    auto worker = [&](int tid) {
+        ThreadTrace* tt = trace.thread(tid);
+        double region_t0 = tt ? trace_now() : 0.0;
+
+        SieveThreadState state;
+        state.init(ctx.wheel, ctx.seg_bits);
+        StealableRange& mine = ranges[(size_t)tid];
+
+        long long local = 0;
+        long long next_in_run = -1;  // segment that would continue the current run
+        long long run_end = -1;      // end the current run was prepared for
+        for (;;) {
+            long long s = mine.pop_front();
+            if (s < 0) {
+                // Own block empty: steal from the worker with the most left
+                int victim = -1;
+                long long most = 0;
+                for (int v = 0; v < num_threads; v++) {
+                    long long left = ranges[(size_t)v].remaining();
+                    if (v != tid && left > most) { most = left; victim = v; }
+                }
+                if (victim < 0) break;  // nothing left anywhere
+
+                long long begin = 0, end = 0;
+                if (!ranges[(size_t)victim].steal_back_half(begin, end)) continue;
+                if (tt) tt->steals++;
+                mine.reset(begin, end);
+                continue;
+            }
+
+            // Anything but the next segment of the current run starts a new run.
+            // Its end is the block end right now; steals only ever shrink it.
+            if (s != next_in_run || s >= run_end) {
+                run_end = mine.back.load(std::memory_order_relaxed);
+                begin_run(state, ctx, s, run_end);
+                if (tt) tt->runs++;
+            }
+            local += sieve_traced_segment(state, ctx, s, tid, tt, visit);
+            next_in_run = s + 1;
+        }
+        counts[(size_t)tid] = local;
+
+        if (tt) tt->region_sec = trace_now() - region_t0;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < num_threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+
+    for (long long c : counts) total += c;
+    return total;
+}
+
+// Run the executor selected in options
+template <typename Visitor>
+long long run_executor(const SieveContext& ctx, const SieveOptions& options, SieveTrace& trace,
+                       Visitor&& visit) {
+    switch (options.executor) {
+        case SieveExecutor::OpenMP:
+            return run_openmp(ctx, options.threads, trace, visit, options.max_run_segments);
+        case SieveExecutor::ThreadPool:
+            return run_thread_pool(ctx, options.threads, trace, visit, options.max_run_segments);
+        case SieveExecutor::Numa:
+            return run_numa(ctx, options.threads, trace, visit, options.max_run_segments);
+        case SieveExecutor::WorkStealing:
+            return run_work_stealing(ctx, options.threads, trace, visit);
+        case SieveExecutor::Pipeline:
+            return run_pipelined(ctx, options.threads, trace, visit, options.max_run_segments);
+        case SieveExecutor::Serial:
+        default:                        return run_serial(ctx, trace, visit);
+    }
+}
+
+// Count primes <= N with the executor selected in options (count-only run).
+// Returns -1 if the options are invalid (unsupported wheel).
+inline long long sieve_count(long long N, const SieveOptions& options, SieveTrace& trace) {
+    SieveContext ctx;
+    if (!build_sieve_context(N, options, ctx, trace)) return -1;
+    return run_executor(ctx, options, trace, NoSegmentVisitor());
+}
+
+// Count primes in [A, B] without sieving below A.
+// Returns -1 if the options are invalid (unsupported wheel).
+inline long long sieve_count_range(long long A, long long B, const SieveOptions& options,
+                                   SieveTrace& trace) {
+    SieveContext ctx;
+    if (!build_range_context(A, B, options, ctx, trace)) return -1;
+    return run_executor(ctx, options, trace, NoSegmentVisitor());
+}
+
+// Run f(tid, item) for item in [0, num_items) on num_threads workers,
+// items handed out in increasing order
+template <typename F>
+void parallel_items(long long num_items, int num_threads, F&& f) {
+    if (num_threads < 1) num_threads = 1;
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(num_threads) schedule(monotonic:dynamic)
+    for (long long item = 0; item < num_items; item++) f(omp_get_thread_num(), item);
+#else
+    std::atomic<long long> next(0);
+    auto worker = [&](int tid) {
+        for (;;) {
+            long long item = next.fetch_add(1, std::memory_order_relaxed);
+            if (item >= num_items) break;
+            f(tid, item);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < num_threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : pool) th.join();
+#endif
+}
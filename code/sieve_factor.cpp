@@ -0,0 +1,174 @@
+// ============================================================
+// sieve_factor.cpp — Batch small-factor screening of RSA-like moduli
+// C++ version of the notebook's rsa_small_factor_check_with_sieve
+// - Reads moduli (64- or 128-bit) and finds every prime factor up to
+//   the bound, reusing the primes of a prime cache when one covers it
+// - Trial division without division instructions, vectorized across
+//   moduli (see sieve_factor.hpp)
+// Usage: ./sieve_factor [threads] [--bound <B>] [--input <file>] [--cache <file>]
+//                      [--random <count> [--bits <2..128>]] [--simd auto|scalar|avx2|avx512]
+//                      [--print]
+// Moduli are read from --input (or stdin), one per line, written as in
+// sieve_primality (e.g. 2^127+1, 10^20-1); --random draws that many odd
+// moduli of the given size from a fixed seed instead
+// --print writes one line per modulus: n: factors... | cofactor=<c>
+// Output: moduli=<count> bound=<B> threads=<T> with_factor=<count> from_cache=<0|1>
+//         time_sec=<time> moduli_per_sec=<rate>
+// ============================================================
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sieve_factor.hpp"
+
+using namespace std;
+using namespace chrono;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+struct FactorArgs {
+    long long bound = 1000000;   // notebook default trial_bound
+    int threads = 1;
+    string input_path;           // empty = stdin
+    string cache_path;
+    long long random_count = 0;  // > 0: random moduli instead of input
+    int random_bits = 128;
+    bool print = false;
+};
+
+// ------------------------------------------------------------
+// Step 1: Parse the options and collect the moduli
+// ------------------------------------------------------------
+bool parse_factor_args(int argc, char* argv[], FactorArgs& args) {
+    bool have_threads = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--bound" && has_value) {
+            args.bound = atoll(argv[++i]);
+        } else if (arg == "--input" && has_value) {
+            args.input_path = argv[++i];
+        } else if (arg == "--cache" && has_value) {
+            args.cache_path = argv[++i];
+        } else if (arg == "--random" && has_value) {
+            args.random_count = atoll(argv[++i]);
+        } else if (arg == "--bits" && has_value) {
+            args.random_bits = atoi(argv[++i]);
+        } else if (arg == "--print") {
+            args.print = true;
+        } else if (arg == "--simd" && has_value) {
+            SimdLevel level = detect_simd_level();
+            if ((string(argv[++i]) != "auto" && !parse_simd_level(argv[i], level)) || !set_simd_level(level)) {
+                fprintf(stderr, "Unknown or unsupported SIMD level %s\n", argv[i]);
+                return false;
+            }
+        } else if (arg.rfind("--", 0) != 0 && !have_threads) {
+            args.threads = atoi(argv[i]);
+            have_threads = true;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    if (args.threads < 1) args.threads = 1;
+    if (args.bound < 1 || args.bound > MAX_FACTOR_BOUND) {
+        fprintf(stderr, "--bound must be in [1, %lld]\n", MAX_FACTOR_BOUND);
+        return false;
+    }
+    if (args.random_bits < 2 || args.random_bits > 128) {
+        fprintf(stderr, "--bits must be in [2, 128]\n");
+        return false;
+    }
+    return true;
+}
+
+bool read_moduli(const FactorArgs& args, vector<uint128_t>& moduli) {
+    if (args.random_count > 0) {
+        mt19937_64 rng(719);
+        for (long long i = 0; i < args.random_count; i++) {
+            uint128_t v = ((uint128_t)rng() << 64) | rng();
+            if (args.random_bits < 128) v &= ((uint128_t)1 << args.random_bits) - 1;
+            v |= ((uint128_t)1 << (args.random_bits - 1)) | 1;   // full size, odd
+            moduli.push_back(v);
+        }
+        return true;
+    }
+
+    FILE* in = args.input_path.empty() ? stdin : fopen(args.input_path.c_str(), "r");
+    if (!in) {
+        fprintf(stderr, "Could not open %s\n", args.input_path.c_str());
+        return false;
+    }
+    char line[256];
+    bool ok = true;
+    while (fgets(line, sizeof(line), in)) {
+        string text(line);
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == ' ')) {
+            text.pop_back();
+        }
+        if (text.empty() || text[0] == '#') continue;
+        uint128_t v = 0;
+        if (!parse_u128(text, v)) {
+            fprintf(stderr, "Bad modulus %s (need an integer below 2^128)\n", text.c_str());
+            ok = false;
+            break;
+        }
+        moduli.push_back(v);
+    }
+    if (in != stdin) fclose(in);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    FactorArgs args;
+    if (!parse_factor_args(argc, argv, args)) return 1;
+
+    vector<uint128_t> moduli;
+    if (!read_moduli(args, moduli)) return 1;
+
+    // ------------------------------------------------------------
+    // Step 2: Primes up to the bound (cache or sieve), then the batch
+    // ------------------------------------------------------------
+    auto t0 = high_resolution_clock::now();
+    bool from_cache = false;
+    TrialDivisors divisors;
+    divisors.build(load_trial_primes(args.bound, args.cache_path, args.threads, from_cache), args.bound);
+    auto t_primes = high_resolution_clock::now();
+
+    vector<FactorResult> results = factor_batch(moduli, divisors, args.threads);
+    auto t1 = high_resolution_clock::now();
+
+    double elapsed = duration<double>(t1 - t0).count();
+    double batch_sec = duration<double>(t1 - t_primes).count();
+
+    long long with_factor = 0;
+    for (const FactorResult& r : results) {
+        if (!r.factors.empty()) with_factor++;
+    }
+
+    if (args.print) {
+        for (size_t i = 0; i < moduli.size(); i++) {
+            printf("%s:", u128_to_string(moduli[i]).c_str());
+            for (uint64_t p : results[i].factors) printf(" %llu", (unsigned long long)p);
+            printf(" | cofactor=%s\n", u128_to_string(results[i].cofactor).c_str());
+        }
+    }
+
+    if constexpr (VERBOSE) {
+        cout << "Trial primes up to " << args.bound << ": " << divisors.primes.size() + (divisors.has_two ? 1 : 0)
+             << (from_cache ? " (from cache)" : " (sieved)") << endl;
+        cout << "Batch time = " << batch_sec << " s, SIMD = " << simd_level_name(simd_kernels().level) << endl;
+    }
+
+    double rate = batch_sec > 0 ? (double)moduli.size() / batch_sec : 0.0;
+    printf("moduli=%zu bound=%lld threads=%d with_factor=%lld from_cache=%d time_sec=%.6f moduli_per_sec=%.0f\n",
+           moduli.size(), args.bound, args.threads, with_factor, from_cache ? 1 : 0, elapsed, rate);
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// ============================================================
+// sieve_factor.hpp — Batch trial factorization by the primes up to a bound
+// Used by sieve_factor.cpp (weak-key screening for the RSA demo)
+// - The primes up to the bound come from a prime cache file when one
+//   covers it (sieve_prime_cache.hpp), otherwise from the base prime
+//   generator; they are turned into divisors once per batch
+// - No division in the hot loop: for odd p with inv = p^-1 mod 2^64 and
+//   limit = (2^64 - 1) / p, p divides n exactly when n * inv <= limit
+//   (mod 2^64), and the quotient is then n * inv. The same holds mod
+//   2^128 for 128-bit moduli.
+// - Moduli are processed in blocks that stay in L1. For 64-bit moduli
+//   each prime is tested against a whole block with one vector kernel
+//   (simd_kernels().any_divisible: AVX-512 / AVX2 / scalar); only a
+//   block with a hit is scanned one modulus at a time. 128-bit moduli
+//   take a scalar loop of the same shape.
+// - Blocks are spread over threads (parallel_items, sieve_executors.hpp)
+// Every prime factor <= bound is found, with multiplicity; what is left is
+// the cofactor (1 if n was fully factored).
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sieve_base_primes.hpp"
+#include "sieve_prime_cache.hpp"
+#include "sieve_primality.hpp"
+#include "sieve_simd.hpp"
+
+// Moduli per block: 8 KiB of 64-bit cofactors, tested against every prime
+static const size_t FACTOR_BLOCK_MODULI = 1024;
+
+// Bounds above this would need primes past uint32_t
+static const long long MAX_FACTOR_BOUND = 4294967295LL;
+
+// Odd primes as exact-division tests (structure of arrays, index-aligned)
+struct TrialDivisors {
+    std::vector<uint32_t> primes;   // odd primes <= bound, increasing
+    std::vector<uint64_t> inv64;    // p^-1 mod 2^64
+    std::vector<uint64_t> limit64;  // (2^64 - 1) / p
+    std::vector<uint128_t> inv128;  // p^-1 mod 2^128
+    std::vector<uint128_t> limit128;
+    long long bound = 0;
+    bool has_two = false;           // 2 <= bound
+
+    void build(const std::vector<uint32_t>& all_primes, long long bound_value) {
+        bound = bound_value;
+        has_two = bound >= 2;
+        primes.clear();
+        for (uint32_t p : all_primes) {
+            if (p > 2 && (long long)p <= bound) primes.push_back(p);
+        }
+        inv64.resize(primes.size());
+        limit64.resize(primes.size());
+        inv128.resize(primes.size());
+        limit128.resize(primes.size());
+        for (size_t j = 0; j < primes.size(); j++) {
+            uint64_t p = primes[j];
+            // Newton's iteration doubles the correct low bits each step: 3 -> 96 after
+            // five steps (enough mod 2^64), one more for mod 2^128
+            uint64_t x = p;
+            for (int i = 0; i < 5; i++) x *= 2 - p * x;
+            uint128_t x2 = x;
+            x2 *= 2 - (uint128_t)p * x2;
+            inv64[j] = x;
+            limit64[j] = UINT64_MAX / p;
+            inv128[j] = x2;
+            limit128[j] = ~(uint128_t)0 / p;
+        }
+    }
+};
+
+// The primes <= bound, from the cache at cache_path if it covers the bound
+// (from_cache = true), otherwise generated
+inline std::vector<uint32_t> load_trial_primes(long long bound, const std::string& cache_path,
+                                               int num_threads, bool& from_cache) {
+    from_cache = false;
+    std::vector<uint32_t> primes;
+    if (!cache_path.empty()) {
+        PrimeCache cache;
+        if (cache.open(cache_path) && cache.covers(bound)) {
+            cache.for_each_prime(bound, [&](long long p) { primes.push_back((uint32_t)p); });
+            from_cache = true;
+            return primes;
+        }
+    }
+    return generate_base_primes(std::max(bound, 2LL), num_threads);
+}
+
+struct FactorResult {
+    std::vector<uint64_t> factors;   // prime factors <= bound, increasing, with multiplicity
+    uint128_t cofactor = 0;          // n divided by all of them
+};
+
+// ------------------------------------------------------------
+// One block of moduli
+// ------------------------------------------------------------
+
+// All moduli of the block below 2^64: one vector test per prime
+inline void factor_block_64(const TrialDivisors& d, const uint128_t* moduli, size_t count,
+                            FactorResult* results) {
+    const SimdKernels& simd = simd_kernels();
+    uint64_t n[FACTOR_BLOCK_MODULI];
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v = (uint64_t)moduli[i];
+        if (v == 0) v = 1;   // 0 has no factorization: reported as cofactor 0
+        if (d.has_two) {
+            while (v % 2 == 0) {
+                results[i].factors.push_back(2);
+                v /= 2;
+            }
+        }
+        n[i] = v;
+    }
+
+    for (size_t j = 0; j < d.primes.size(); j++) {
+        uint64_t inv = d.inv64[j], limit = d.limit64[j];
+        if (!simd.any_divisible(n, count, inv, limit)) continue;
+        for (size_t i = 0; i < count; i++) {
+            while (n[i] * inv <= limit && n[i] > 1) {
+                results[i].factors.push_back(d.primes[j]);
+                n[i] *= inv;   // exact quotient
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) results[i].cofactor = moduli[i] == 0 ? 0 : n[i];
+}
+
+// Any 128-bit modulus in the block: scalar tests mod 2^128
+inline void factor_block_128(const TrialDivisors& d, const uint128_t* moduli, size_t count,
+                             FactorResult* results) {
+    uint128_t n[FACTOR_BLOCK_MODULI];
+    for (size_t i = 0; i < count; i++) {
+        uint128_t v = moduli[i] == 0 ? 1 : moduli[i];
+        if (d.has_two) {
+            while ((v & 1) == 0) {
+                results[i].factors.push_back(2);
+                v >>= 1;
+            }
+        }
+        n[i] = v;
+    }
+
+    for (size_t j = 0; j < d.primes.size(); j++) {
+        uint128_t inv = d.inv128[j], limit = d.limit128[j];
+        bool any = false;
+        for (size_t i = 0; i < count; i++) any |= n[i] * inv <= limit;
+        if (!any) continue;
+        for (size_t i = 0; i < count; i++) {
+            while (n[i] * inv <= limit && n[i] > 1) {
+                results[i].factors.push_back(d.primes[j]);
+                n[i] *= inv;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) results[i].cofactor = moduli[i] == 0 ? 0 : n[i];
+}
+
+// ------------------------------------------------------------
+// The batch
+// ------------------------------------------------------------
+
+// Trial-factor every modulus by the primes in d, on num_threads threads.
+// results[i] belongs to moduli[i].
+inline std::vector<FactorResult> factor_batch(const std::vector<uint128_t>& moduli,
+                                              const TrialDivisors& d, int num_threads) {
+    std::vector<FactorResult> results(moduli.size());
+
+    // 64-bit and 128-bit moduli go to separate blocks, so a single wide
+    // modulus does not push a whole block onto the scalar path
+    std::vector<size_t> narrow, wide;
+    for (size_t i = 0; i < moduli.size(); i++) {
+        ((moduli[i] >> 64) == 0 ? narrow : wide).push_back(i);
+    }
+    long long narrow_blocks = (long long)((narrow.size() + FACTOR_BLOCK_MODULI - 1) / FACTOR_BLOCK_MODULI);
+    long long wide_blocks = (long long)((wide.size() + FACTOR_BLOCK_MODULI - 1) / FACTOR_BLOCK_MODULI);
+
+    parallel_items(narrow_blocks + wide_blocks, num_threads, [&](int, long long block) {
+        bool is_wide = block >= narrow_blocks;
+        const std::vector<size_t>& ids = is_wide ? wide : narrow;
+        size_t begin = (size_t)(is_wide ? block - narrow_blocks : block) * FACTOR_BLOCK_MODULI;
+        size_t count = std::min(FACTOR_BLOCK_MODULI, ids.size() - begin);
+
+        uint128_t values[FACTOR_BLOCK_MODULI];
+        std::vector<FactorResult> local(count);
+        for (size_t i = 0; i < count; i++) values[i] = moduli[ids[begin + i]];
+        if (is_wide) {
+            factor_block_128(d, values, count, local.data());
+        } else {
+            factor_block_64(d, values, count, local.data());
+        }
+        for (size_t i = 0; i < count; i++) results[ids[begin + i]] = std::move(local[i]);
+    });
+    return results;
+}
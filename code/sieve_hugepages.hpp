@@ -0,0 +1,217 @@
+// ============================================================
+// sieve_hugepages.hpp — Anonymous memory on huge pages, with fallback
+// Used by PrimeCache (sieve_prime_cache.hpp) to hold a cache in memory
+// for random is_prime(x) / pi(x) lookups, where 4 KiB pages make nearly
+// every lookup a TLB miss
+// - HugePageBuffer::allocate(size, policy) tries, in order:
+//     1g:  explicit 1 GiB pages   (MAP_HUGETLB | MAP_HUGE_1GB)
+//     2m:  explicit 2 MiB pages   (MAP_HUGETLB | MAP_HUGE_2MB)
+//     thp: normal pages, 2 MiB aligned, with madvise(MADV_HUGEPAGE) so the
+//          kernel can back them with transparent huge pages
+//   Each policy falls back to the ones below it, and finally to plain
+//   pages. Explicit pages need a pool (/proc/sys/vm/nr_hugepages or
+//   hugepages= at boot); without one the mmap fails and the next option
+//   is tried.
+// - backing() says which mapping was obtained. huge_bytes() says how much
+//   of it is really on huge pages: all of it for explicit pages, and for
+//   THP what /proc/self/smaps reports (AnonHugePages) after first touch.
+// Memory comes straight from mmap, so it is page aligned (and therefore
+// cache-line aligned) and returned to the system on release().
+// ============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sieve_mmap.hpp"
+
+static const size_t HUGE_PAGE_2M = 2ULL << 20;
+static const size_t HUGE_PAGE_1G = 1ULL << 30;
+
+// What to ask for
+enum class HugePagePolicy { Off, Transparent, Huge2M, Huge1G };
+
+// What was obtained
+enum class HugePageBacking { Normal, Transparent, Huge2M, Huge1G };
+
+inline bool parse_huge_page_policy(const std::string& name, HugePagePolicy& out) {
+    if (name == "off") { out = HugePagePolicy::Off; return true; }
+    if (name == "thp") { out = HugePagePolicy::Transparent; return true; }
+    if (name == "2m")  { out = HugePagePolicy::Huge2M; return true; }
+    if (name == "1g")  { out = HugePagePolicy::Huge1G; return true; }
+    return false;
+}
+
+inline const char* huge_page_backing_name(HugePageBacking b) {
+    switch (b) {
+        case HugePageBacking::Transparent: return "thp";
+        case HugePageBacking::Huge2M:      return "2m";
+        case HugePageBacking::Huge1G:      return "1g";
+        case HugePageBacking::Normal:
+        default:                           return "off";
+    }
+}
+
+inline size_t round_up_size(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// AnonHugePages of the mapping that contains addr, in bytes (Linux; 0 elsewhere)
+inline size_t smaps_anon_huge_bytes(const void* addr) {
+    size_t bytes = 0;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+    uintptr_t a = (uintptr_t)addr;
+    bool inside = false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long lo = 0, hi = 0;
+        size_t kb = 0;
+        if (sscanf(line, "%llx-%llx ", &lo, &hi) == 2) {
+            inside = lo <= a && a < hi;   // a new mapping starts
+        } else if (inside && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            bytes = kb * 1024;
+            break;
+        }
+    }
+    fclose(f);
+#else
+    (void)addr;
+#endif
+    return bytes;
+}
+
+class HugePageBuffer {
+public:
+    HugePageBuffer() = default;
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+    HugePageBuffer(HugePageBuffer&& other) noexcept { swap(other); }
+    HugePageBuffer& operator=(HugePageBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+    ~HugePageBuffer() { release(); }
+
+    // Get size bytes (zero-filled) on the best pages policy allows.
+    // Returns false only if no memory could be mapped at all.
+    bool allocate(size_t size, HugePagePolicy policy) {
+        release();
+        if (size == 0) return true;
+#if SIEVE_HAVE_MMAP
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        if (policy == HugePagePolicy::Huge1G && map_hugetlb(size, HUGE_PAGE_1G, 30)) {
+            backing_ = HugePageBacking::Huge1G;
+            return true;
+        }
+        if ((policy == HugePagePolicy::Huge1G || policy == HugePagePolicy::Huge2M) &&
+                map_hugetlb(size, HUGE_PAGE_2M, 21)) {
+            backing_ = HugePageBacking::Huge2M;
+            return true;
+        }
+#endif
+        // Normal pages. For THP the mapping starts on a 2 MiB boundary, so
+        // every whole 2 MiB stretch of it can become one huge page.
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t length = round_up_size(size, page);
+        size_t slack = policy == HugePagePolicy::Off ? 0 : HUGE_PAGE_2M;
+        void* p = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return false;
+        uintptr_t start = (uintptr_t)p;
+        uintptr_t aligned = slack > 0 ? round_up_size(start, slack) : start;
+        if (aligned > start) ::munmap(p, aligned - start);
+        if (start + slack > aligned) ::munmap((void*)(aligned + length), start + slack - aligned);
+
+        map_ = (void*)aligned;
+        map_size_ = length;
+        size_ = size;
+        backing_ = HugePageBacking::Normal;
+#if defined(MADV_HUGEPAGE)
+        if (policy != HugePagePolicy::Off && ::madvise(map_, map_size_, MADV_HUGEPAGE) == 0) {
+            backing_ = HugePageBacking::Transparent;
+        }
+#endif
+        return true;
+#else
+        (void)policy;
+        heap_.assign(size, 0);
+        size_ = size;
+        backing_ = HugePageBacking::Normal;
+        return true;
+#endif
+    }
+
+    void release() {
+#if SIEVE_HAVE_MMAP
+        if (map_ != nullptr) ::munmap(map_, map_size_);
+#else
+        std::vector<uint8_t>().swap(heap_);
+#endif
+        map_ = nullptr;
+        map_size_ = 0;
+        size_ = 0;
+        backing_ = HugePageBacking::Normal;
+    }
+
+    uint8_t* data() {
+#if SIEVE_HAVE_MMAP
+        return static_cast<uint8_t*>(map_);
+#else
+        return heap_.data();
+#endif
+    }
+    const uint8_t* data() const { return const_cast<HugePageBuffer*>(this)->data(); }
+    size_t size() const { return size_; }
+    HugePageBacking backing() const { return backing_; }
+
+    // Bytes of the buffer that are on huge pages now. THP pages appear
+    // as the buffer is touched (or later, when khugepaged collapses them).
+    size_t huge_bytes() const {
+        switch (backing_) {
+            case HugePageBacking::Huge1G:
+            case HugePageBacking::Huge2M:      return map_size_;
+            case HugePageBacking::Transparent: return smaps_anon_huge_bytes(map_);
+            case HugePageBacking::Normal:
+            default:                           return 0;
+        }
+    }
+
+private:
+#if SIEVE_HAVE_MMAP && defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    // Explicit huge pages of 2^shift bytes. Fails (no memory is taken)
+    // when the pool cannot reserve them.
+    bool map_hugetlb(size_t size, size_t page, int shift) {
+        size_t length = round_up_size(size, page);
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT);
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED) return false;
+        map_ = p;
+        map_size_ = length;
+        size_ = size;
+        return true;
+    }
+#endif
+
+    void swap(HugePageBuffer& other) {
+        std::swap(map_, other.map_);
+        std::swap(map_size_, other.map_size_);
+        std::swap(size_, other.size_);
+        std::swap(backing_, other.backing_);
+        heap_.swap(other.heap_);
+    }
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;   // mapped length (whole pages)
+    size_t size_ = 0;       // requested length
+    HugePageBacking backing_ = HugePageBacking::Normal;
+    std::vector<uint8_t> heap_;   // only without mmap
+};
@@ -0,0 +1,152 @@
+// ============================================================
+// sieve_hybrid.hpp — CPU + GPU co-scheduling of one sieve run
+// Used by sieve_cuda.cpp when it is given a CPU thread count
+// - CPU workers and one GPU feeder thread take segments from the same
+//   atomic counter, so both sides work on one range and nobody sits idle
+// - CPU workers claim short runs (as in run_thread_pool) and sieve them
+//   with the shared kernel
+// - The GPU feeder claims chunks sized from live throughput: the first
+//   HYBRID_PROBE_CHUNKS chunks are one batch each (at most 1/16 of the
+//   range, so a short range is not handed to the GPU blind); after that
+//   each chunk is half of the GPU's share of the remaining segments, where
+//   the share is gpu_rate / (gpu_rate + cpu_rate) measured so far. Chunks
+//   shrink towards the end, so both sides finish at about the same time.
+// - If the GPU fails mid-run, the feeder sieves its claimed chunk on the
+//   CPU and carries on as a CPU worker; the count stays correct and the
+//   error is reported
+// Both sides see the same SieveContext, so segment ids mean the same
+// numbers on the CPU and the GPU.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+#include "sieve_cuda.hpp"
+
+// GPU chunks of one batch each before the split is computed from rates
+static const int HYBRID_PROBE_CHUNKS = 2;
+
+// Smallest GPU chunk once the split is rate-based (keeps launches worthwhile)
+static const long long HYBRID_MIN_GPU_CHUNK = 64;
+
+struct HybridStats {
+    long long cpu_segments = 0;
+    long long gpu_segments = 0;
+    long long gpu_chunks = 0;
+    double gpu_share = 0.0;     // last measured GPU share of the throughput
+};
+
+// Count the primes of ctx with cpu_threads CPU workers plus the GPU session
+// gpu (opened on the same context). Trace slots 0..cpu_threads-1 are the
+// CPU workers, slot cpu_threads is the GPU feeder. error is set if the GPU
+// failed; the count is still complete.
+inline long long run_hybrid(const SieveContext& ctx, int cpu_threads, CudaSieve& gpu,
+                            SieveTrace& trace, HybridStats& stats, std::string& error) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (cpu_threads < 0) cpu_threads = 0;
+
+    long long num_segments = ctx.num_segments;
+    long long run_length = plan_run_length(ctx, std::max(1, cpu_threads));
+
+    std::atomic<long long> next_segment(0);   // first unclaimed segment
+    std::atomic<long long> cpu_done(0);       // segments finished by CPU workers
+    std::vector<long long> counts((size_t)cpu_threads + 1, 0);
+    double start = trace_now();
+
+    // Sieve [begin, end) on the CPU, then keep claiming runs until none are left
+    auto cpu_runs = [&](int tid, long long begin, long long end) {
+        ThreadTrace* tt = trace.thread(tid);
+        SieveThreadState state;
+        state.init(ctx.wheel, ctx.seg_bits);
+        NoSegmentVisitor visit;
+
+        long long local = 0;
+        while (begin < num_segments) {
+            local += sieve_run(state, ctx, begin, end, tid, tt, visit);
+            cpu_done.fetch_add(end - begin, std::memory_order_relaxed);
+            begin = next_segment.fetch_add(run_length, std::memory_order_relaxed);
+            end = std::min(begin + run_length, num_segments);
+        }
+        return local;
+    };
+
+    auto cpu_worker = [&](int tid) {
+        ThreadTrace* tt = trace.thread(tid);
+        long long begin = next_segment.fetch_add(run_length, std::memory_order_relaxed);
+        counts[(size_t)tid] = cpu_runs(tid, begin, std::min(begin + run_length, num_segments));
+        if (tt) tt->region_sec = trace_now() - start;
+    };
+
+    auto gpu_feeder = [&]() {
+        int tid = cpu_threads;
+        ThreadTrace* tt = trace.thread(tid);
+        long long gpu_done = 0;
+        double gpu_sec = 0.0;
+        long long local = 0;
+
+        long long probe = std::max(1LL, std::min(CUDA_BATCH_SEGMENTS, num_segments / 16));
+        for (long long k = 0;; k++) {
+            long long chunk = probe;
+            if (k >= HYBRID_PROBE_CHUNKS) {
+                // Rates in segments per second; the CPU rate covers all workers
+                double cpu_rate = cpu_done.load(std::memory_order_relaxed) / std::max(1e-9, trace_now() - start);
+                double gpu_rate = gpu_done / std::max(1e-9, gpu_sec);
+                stats.gpu_share = cpu_threads == 0 ? 1.0 : gpu_rate / (gpu_rate + cpu_rate);
+
+                // Half of the fair share: the rest is re-split with fresher rates
+                long long remaining = num_segments - next_segment.load(std::memory_order_relaxed);
+                long long fair = (long long)(stats.gpu_share * (double)remaining);
+                if (cpu_threads == 0) fair = remaining;
+                if (fair < 1) break;   // the CPU finishes the tail sooner than a GPU chunk would
+                chunk = std::min(fair, std::max(HYBRID_MIN_GPU_CHUNK, fair / 2));
+            }
+
+            long long begin = next_segment.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= num_segments) break;
+            long long end = std::min(begin + chunk, num_segments);
+
+            double t0 = trace_now();
+            std::string gpu_error;
+            long long c = gpu.sieve(begin, end, CudaSegmentSink(), gpu_error);
+            if (c < 0) {
+                // Sieve the chunk on the CPU and carry on as one more CPU worker
+                error = gpu_error;
+                local += cpu_runs(tid, begin, end);
+                break;
+            }
+            double dt = trace_now() - t0;
+
+            local += c;
+            gpu_done += end - begin;
+            gpu_sec += dt;
+            stats.gpu_chunks++;
+            if (tt) {
+                tt->runs++;
+                tt->segments += end - begin;
+                tt->primes += c;
+                tt->busy_sec += dt;
+            }
+        }
+        stats.gpu_segments = gpu_done;
+        counts[(size_t)tid] = local;
+        if (tt) tt->region_sec = trace_now() - start;
+    };
+
+    std::vector<std::thread> pool;
+    pool.emplace_back(gpu_feeder);
+    for (int t = 1; t < cpu_threads; t++) pool.emplace_back(cpu_worker, t);
+    if (cpu_threads > 0) cpu_worker(0);
+    for (std::thread& th : pool) th.join();
+
+    stats.cpu_segments = cpu_done.load();
+    for (long long c : counts) total += c;
+    return total;
+}
@@ -0,0 +1,92 @@
+// ============================================================
+// sieve_incremental.cpp — Grow the prime horizon step by step
+// Driver for IncrementalSieve (see sieve_incremental.hpp)
+// - Counts pi(N) for an increasing list of horizons with one sieve
+//   object: each step only sieves (previous N, next N], so a sweep
+//   1e6 -> 1e7 -> 1e8 costs one sieve up to 1e8, not three
+// - Any executor of the shared engine does the sieving
+// Usage: ./sieve_incremental <N1> [N2 ...] [--threads <T>] [--executor <name>]
+//                           [--wheel <modulus>] [--segment-bytes <B>] [--presieve <limit>]
+// Horizons accept 1e9-style values; a horizon below the previous one is
+// answered from the checkpoints (sieving only from the nearest one below)
+// Output: one line per horizon: N=<N> count=<pi(N)> step_sec=<time> total_sec=<time>
+// ============================================================
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sieve_incremental.hpp"
+#include "sieve_cli.hpp"
+
+using namespace std;
+using namespace chrono;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+int main(int argc, char* argv[]) {
+    SieveOptions options;
+    vector<long long> horizons;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--executor" && has_value) {
+            if (!parse_executor_name(argv[++i], options.executor)) {
+                fprintf(stderr, "Unknown executor %s (use serial, openmp, pool, numa, steal or pipeline)\n", argv[i]);
+                return 1;
+            }
+        } else if (arg == "--wheel" && has_value) {
+            options.wheel_modulus = atoll(argv[++i]);
+        } else if (arg == "--segment-bytes" && has_value) {
+            options.segment_bytes = atoll(argv[++i]);
+        } else if (arg == "--presieve" && has_value) {
+            if (!parse_presieve_limit(argv[++i], options.presieve_limit)) return 1;
+        } else if (arg.rfind("--", 0) == 0) {
+            fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+            return 1;
+        } else {
+            long long N = 0;
+            if (!parse_count(arg, N)) return 1;
+            horizons.push_back(N);
+        }
+    }
+    if (horizons.empty()) {
+        fprintf(stderr, "Usage: %s <N1> [N2 ...] [--threads <T>] [--executor <name>]\n", argv[0]);
+        return 1;
+    }
+    if (options.threads < 1) options.threads = 1;
+    if (options.threads > 1 && options.executor == SieveExecutor::Serial) {
+        options.executor = SieveExecutor::ThreadPool;
+    }
+    WheelPattern wheel_check;
+    if (!wheel_check.build(options.wheel_modulus)) {
+        fprintf(stderr, "Unsupported wheel modulus %lld (use 2, 6, 30, 210, 2310, 30030 or 510510)\n",
+                options.wheel_modulus);
+        return 1;
+    }
+
+    IncrementalSieve sieve(options);
+    SieveTrace trace;
+    auto t0 = high_resolution_clock::now();
+    for (long long N : horizons) {
+        auto step_t0 = high_resolution_clock::now();
+        long long count = sieve.pi(N, trace);
+        auto step_t1 = high_resolution_clock::now();
+
+        if constexpr (VERBOSE) {
+            cout << "Horizon " << sieve.horizon() << ", base primes held = " << sieve.base_primes().size()
+                 << ", checkpoints = " << sieve.checkpoints().size() << endl;
+        }
+
+        printf("N=%lld count=%lld step_sec=%.6f total_sec=%.6f\n", N, count,
+               duration<double>(step_t1 - step_t0).count(), duration<double>(step_t1 - t0).count());
+        fflush(stdout);
+    }
+    return 0;
+}
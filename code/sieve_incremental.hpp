@@ -0,0 +1,118 @@
+// ============================================================
+// sieve_incremental.hpp — Extendable sieve: grow [2, N1] to [2, N2]
+// Used by sieve_incremental.cpp (and anything that keeps a prime horizon
+// alive between queries, e.g. a long-running service)
+// - IncrementalSieve keeps the base primes, the current horizon N and
+//   pi(N) between calls
+// - extend_to(N2) sieves only (N, N2] as a range run of the shared engine
+//   (any executor) and adds the count to pi(N)
+// - Base primes are grown on demand: when sqrt(N2) passes the largest
+//   one, only the new stretch of base primes is sieved, using the base
+//   primes already known. The stretch at least doubles the limit, so a
+//   horizon grown in small steps does not keep re-sieving tiny stretches.
+// - Every horizon reached is kept as a checkpoint, so pi(x) below the
+//   horizon only sieves from the nearest checkpoint below x
+// Per-prime offsets are set up per run by the engine (one division per
+// base prime), which is negligible next to the sieving of (N, N2].
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+// Base primes never need to pass sqrt(2^63 - 1)
+static const long long MAX_BASE_PRIME_LIMIT = 3037000499LL;
+
+class IncrementalSieve {
+public:
+    explicit IncrementalSieve(const SieveOptions& options = SieveOptions()) : options_(options) {
+        checkpoints_.push_back({1, 0});
+    }
+
+    long long horizon() const { return N_; }
+    long long count() const { return count_; }   // pi(horizon())
+    const std::vector<uint32_t>& base_primes() const { return primes_; }
+    const std::vector<std::pair<long long, long long>>& checkpoints() const { return checkpoints_; }
+
+    // Grow the horizon to N2, sieving only (horizon, N2]. Returns pi(N2),
+    // or -1 if the options are invalid (unsupported wheel). N2 <= horizon
+    // changes nothing and returns pi(horizon).
+    long long extend_to(long long N2, SieveTrace& trace) {
+        if (N2 <= N_) return count_;
+        grow_base_primes(integer_sqrt(N2), trace);
+
+        long long added = count_range(N_ + 1, N2, trace);
+        if (added < 0) return -1;
+        count_ += added;
+        N_ = N2;
+        checkpoints_.push_back({N_, count_});
+        return count_;
+    }
+
+    long long extend_to(long long N2) {
+        SieveTrace trace;
+        return extend_to(N2, trace);
+    }
+
+    // pi(x). Above the horizon this extends it; below, only the numbers
+    // between x and the nearest checkpoint under it are sieved.
+    long long pi(long long x, SieveTrace& trace) {
+        if (x < 2) return 0;
+        if (x >= N_) return extend_to(x, trace);
+        auto it = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), std::make_pair(x, LLONG_MAX));
+        const std::pair<long long, long long>& below = *(it - 1);   // checkpoints_[0] = (1, 0)
+        if (below.first == x) return below.second;
+        long long added = count_range(below.first + 1, x, trace);
+        return added < 0 ? -1 : below.second + added;
+    }
+
+private:
+    // Primes in [A, B] with the base primes already held (they must reach
+    // sqrt(B)). The list is lent to the context and taken back afterwards.
+    long long count_range(long long A, long long B, SieveTrace& trace) {
+        SieveContext ctx;
+        if (!prepare_range_context(A, B, options_, ctx)) return -1;
+        set_base_primes(ctx, std::move(primes_));
+        long long count = run_executor(ctx, options_, trace, NoSegmentVisitor());
+        primes_ = std::move(ctx.base_primes);
+        return count;
+    }
+
+    // Make sure the base primes reach limit
+    void grow_base_primes(long long limit, SieveTrace& trace) {
+        if (limit <= base_limit_) return;
+        long long target = std::min(std::max(limit, 2 * base_limit_), MAX_BASE_PRIME_LIMIT);
+
+        double phase_t0 = trace_now();
+        SieveContext ctx;
+        if (base_limit_ < 2 || base_limit_ * base_limit_ < target ||
+            !prepare_range_context(base_limit_ + 1, target, options_, ctx)) {
+            // The known primes cannot sieve the new stretch: start over
+            primes_ = generate_base_primes(target, options_.threads);
+        } else {
+            // Sieve (base_limit, target] with the known primes and append, in order
+            std::vector<uint32_t> found;
+            set_base_primes(ctx, std::move(primes_));
+            run_serial(ctx, trace, [&found](int, const SieveThreadState& state, const SegmentResult&) {
+                state.segment.for_each_set([&found](long long p) { found.push_back((uint32_t)p); });
+            });
+            primes_ = std::move(ctx.base_primes);
+            primes_.insert(primes_.end(), found.begin(), found.end());
+        }
+        trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+        base_limit_ = target;
+    }
+
+    SieveOptions options_;
+    long long N_ = 1;             // every prime <= N_ has been counted
+    long long count_ = 0;         // pi(N_)
+    std::vector<uint32_t> primes_;
+    long long base_limit_ = 1;    // primes_ holds every prime <= base_limit_
+    std::vector<std::pair<long long, long long>> checkpoints_;   // (horizon, pi(horizon)), increasing
+};
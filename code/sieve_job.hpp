@@ -0,0 +1,347 @@
+// ============================================================
+// sieve_job.hpp — Long runs as jobs: deadline, cancellation, progress,
+// checkpoint and resume
+// Used by sieve_serial.cpp and sieve_openmp.cpp (--checkpoint, --deadline,
+// --progress)
+// - The segments are cut into blocks of JOB_BLOCK_SEGMENTS. Threads take
+//   blocks in increasing order (parallel_items) and sieve each block as
+//   one run of the engine.
+// - Before every segment a worker checks the stop condition: the cancel
+//   token (the drivers set it on SIGINT / SIGTERM) or the deadline. A
+//   stopped worker leaves its block part-done and takes no new block.
+// - Per block the job keeps how many of its segments are done (always a
+//   prefix of the block) and how many primes they held.
+// - A monitor thread prints progress (segments/s, ETA) to stderr and
+//   writes the blocks to the checkpoint file every interval, and once more
+//   at the end. It writes <file>.tmp and renames it over <file>, so a
+//   crash leaves either the old or the new checkpoint, never half of one.
+// - Resuming reads the file, checks that it belongs to the same range and
+//   segment geometry, and sieves only what is missing: a part-done block
+//   restarts at its first missing segment.
+// Checkpoint file (text):
+//   sieve-checkpoint 1
+//   A=<A> N=<N> first_value=<v> seg_bits=<b> num_segments=<s> block_segments=<k>
+//   <block> <segments done> <primes>      (one line per started block)
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+// Segments per checkpointed block (the engine's longest run)
+static const long long JOB_BLOCK_SEGMENTS = MAX_RUN_SEGMENTS;
+
+static const int JOB_CHECKPOINT_VERSION = 1;
+
+// Set from any thread, or from a signal handler, to stop a job early
+class CancelToken {
+public:
+    void cancel() { flag_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag_.load(std::memory_order_relaxed); }
+
+private:
+    static_assert(std::atomic<bool>::is_always_lock_free, "the signal handler needs a lock-free flag");
+    std::atomic<bool> flag_{false};
+};
+
+struct JobOptions {
+    std::string checkpoint_path;          // empty = no checkpoint (nothing to resume)
+    double checkpoint_interval_sec = 30;  // how often the checkpoint is rewritten
+    double deadline_sec = 0;              // time budget from the start of the job (0 = none)
+    double progress_interval_sec = 0;     // progress lines on stderr (0 = none)
+    CancelToken* cancel = nullptr;
+};
+
+struct JobResult {
+    long long count = 0;             // primes in the finished segments (plus 2)
+    long long segments_done = 0;     // including the resumed ones
+    long long num_segments = 0;
+    long long resumed_segments = 0;  // done before this run started
+    double segments_per_sec = 0;     // this run only
+
+    bool complete() const { return segments_done == num_segments; }
+};
+
+// ------------------------------------------------------------
+// The checkpoint file
+// ------------------------------------------------------------
+struct JobCheckpoint {
+    long long A = 0, N = 0, first_value = 0, seg_bits = 0, num_segments = 0;
+    long long block_segments = JOB_BLOCK_SEGMENTS;
+    std::vector<long long> done;     // per block: segments done
+    std::vector<long long> primes;   // per block: primes in them
+
+    long long num_blocks() const { return (num_segments + block_segments - 1) / block_segments; }
+
+    long long block_length(long long b) const {
+        return std::min(block_segments, num_segments - b * block_segments);
+    }
+
+    // An empty checkpoint for ctx
+    static JobCheckpoint fresh(const SieveContext& ctx) {
+        JobCheckpoint cp;
+        cp.A = ctx.A;
+        cp.N = ctx.N;
+        cp.first_value = ctx.first_value;
+        cp.seg_bits = ctx.seg_bits;
+        cp.num_segments = ctx.num_segments;
+        cp.done.assign((size_t)cp.num_blocks(), 0);
+        cp.primes.assign((size_t)cp.num_blocks(), 0);
+        return cp;
+    }
+
+    // Same numbers in the same segments (the wheel and pre-sieve do not
+    // change the counts, so they may differ between runs)
+    bool matches(const JobCheckpoint& other) const {
+        return A == other.A && N == other.N && first_value == other.first_value &&
+               seg_bits == other.seg_bits && num_segments == other.num_segments &&
+               block_segments == other.block_segments;
+    }
+};
+
+inline bool write_job_checkpoint(const std::string& path, const JobCheckpoint& cp) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "sieve-checkpoint %d\n", JOB_CHECKPOINT_VERSION);
+    fprintf(f, "A=%lld N=%lld first_value=%lld seg_bits=%lld num_segments=%lld block_segments=%lld\n",
+            cp.A, cp.N, cp.first_value, cp.seg_bits, cp.num_segments, cp.block_segments);
+    for (size_t b = 0; b < cp.done.size(); b++) {
+        if (cp.done[b] > 0) fprintf(f, "%zu %lld %lld\n", b, cp.done[b], cp.primes[b]);
+    }
+    bool ok = fflush(f) == 0;
+    ok = (fclose(f) == 0) && ok;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Returns false if the file cannot be opened (exists = false) or is not a
+// valid checkpoint (exists = true)
+inline bool read_job_checkpoint(const std::string& path, JobCheckpoint& cp, bool& exists) {
+    FILE* f = fopen(path.c_str(), "r");
+    exists = f != nullptr;
+    if (!f) return false;
+
+    int version = 0;
+    bool ok = fscanf(f, "sieve-checkpoint %d", &version) == 1 && version == JOB_CHECKPOINT_VERSION &&
+              fscanf(f, " A=%lld N=%lld first_value=%lld seg_bits=%lld num_segments=%lld block_segments=%lld",
+                     &cp.A, &cp.N, &cp.first_value, &cp.seg_bits, &cp.num_segments,
+                     &cp.block_segments) == 6 &&
+              cp.num_segments >= 0 && cp.block_segments > 0;
+    if (ok) {
+        cp.done.assign((size_t)cp.num_blocks(), 0);
+        cp.primes.assign((size_t)cp.num_blocks(), 0);
+        long long b = 0, done = 0, primes = 0;
+        while (ok && fscanf(f, " %lld %lld %lld", &b, &done, &primes) == 3) {
+            ok = b >= 0 && b < cp.num_blocks() && done >= 0 && done <= cp.block_length(b) && primes >= 0;
+            if (ok) {
+                cp.done[(size_t)b] = done;
+                cp.primes[(size_t)b] = primes;
+            }
+        }
+        ok = ok && feof(f);
+    }
+    fclose(f);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// Running a job
+// ------------------------------------------------------------
+
+// Progress of one block, shared by its worker and the monitor
+struct JobBlock {
+    std::mutex lock;
+    long long done = 0;
+    long long primes = 0;
+};
+
+// Count ctx's primes as a job. Resumes from job.checkpoint_path if that
+// file exists. Returns false on error (bad checkpoint, cannot write it);
+// a run stopped by the deadline or the cancel token returns true with
+// result.complete() == false.
+inline bool run_sieve_job(const SieveContext& ctx, const SieveOptions& options, const JobOptions& job,
+                          SieveTrace& trace, JobResult& result) {
+    double t0 = trace_now();
+    JobCheckpoint cp = JobCheckpoint::fresh(ctx);
+    if (!job.checkpoint_path.empty()) {
+        JobCheckpoint saved;
+        bool exists = false;
+        if (read_job_checkpoint(job.checkpoint_path, saved, exists)) {
+            if (!saved.matches(cp)) {
+                fprintf(stderr, "Checkpoint %s is for another range or segment size\n",
+                        job.checkpoint_path.c_str());
+                return false;
+            }
+            cp = saved;
+        } else if (exists) {
+            fprintf(stderr, "Checkpoint %s is not a valid checkpoint file\n", job.checkpoint_path.c_str());
+            return false;
+        }
+    }
+
+    long long num_blocks = cp.num_blocks();
+    std::vector<JobBlock> blocks((size_t)num_blocks);
+    long long resumed = 0;
+    for (long long b = 0; b < num_blocks; b++) {
+        blocks[(size_t)b].done = cp.done[(size_t)b];
+        blocks[(size_t)b].primes = cp.primes[(size_t)b];
+        resumed += cp.done[(size_t)b];
+    }
+
+    std::atomic<long long> segments_done(resumed);
+    std::atomic<bool> stopped(false);
+    double deadline = job.deadline_sec > 0 ? t0 + job.deadline_sec : 0.0;
+    auto should_stop = [&]() {
+        if (job.cancel && job.cancel->cancelled()) return true;
+        return deadline > 0 && trace_now() >= deadline;
+    };
+
+    // Copy every block's progress (each under its own lock, so done and
+    // primes always agree) and write it out
+    auto save = [&]() {
+        for (long long b = 0; b < num_blocks; b++) {
+            std::lock_guard<std::mutex> hold(blocks[(size_t)b].lock);
+            cp.done[(size_t)b] = blocks[(size_t)b].done;
+            cp.primes[(size_t)b] = blocks[(size_t)b].primes;
+        }
+        return write_job_checkpoint(job.checkpoint_path, cp);
+    };
+
+    // Monitor: progress lines and periodic checkpoints while the workers run
+    std::mutex monitor_lock;
+    std::condition_variable monitor_wake;
+    bool finished = false;
+    bool save_failed = false;
+    auto monitor = [&]() {
+        double next_progress = t0 + job.progress_interval_sec;
+        double next_save = t0 + job.checkpoint_interval_sec;
+        std::unique_lock<std::mutex> hold(monitor_lock);
+        while (!finished) {
+            monitor_wake.wait_for(hold, std::chrono::milliseconds(100));
+            if (finished) break;
+            double now = trace_now();
+            if (job.progress_interval_sec > 0 && now >= next_progress) {
+                long long done = segments_done.load(std::memory_order_relaxed);
+                double rate = (double)(done - resumed) / (now - t0);
+                double eta = rate > 0 ? (double)(cp.num_segments - done) / rate : -1.0;
+                fprintf(stderr, "progress segments=%lld/%lld pct=%.1f segments_per_sec=%.1f eta_sec=%.0f\n",
+                        done, cp.num_segments, 100.0 * (double)done / (double)std::max(1LL, cp.num_segments),
+                        rate, eta);
+                next_progress = now + job.progress_interval_sec;
+            }
+            if (!job.checkpoint_path.empty() && job.checkpoint_interval_sec > 0 && now >= next_save) {
+                if (!save()) save_failed = true;
+                next_save = now + job.checkpoint_interval_sec;
+            }
+        }
+    };
+    std::thread monitor_thread;
+    if (job.progress_interval_sec > 0 || !job.checkpoint_path.empty()) monitor_thread = std::thread(monitor);
+
+    // Workers: one block per item, resumed at its first missing segment
+    int workers = std::max(1, options.threads);
+    std::vector<SieveThreadState> states((size_t)workers);
+    std::vector<char> ready((size_t)workers, 0);
+    double sieve_t0 = trace_now();
+    parallel_items(num_blocks, workers, [&](int tid, long long b) {
+        if (stopped.load(std::memory_order_relaxed)) return;
+        JobBlock& block = blocks[(size_t)b];
+        long long begin = b * cp.block_segments + block.done;   // only this worker changes done
+        long long end = b * cp.block_segments + cp.block_length(b);
+        if (begin >= end) return;
+
+        ThreadTrace* tt = trace.thread(tid);
+        double region_t0 = tt ? trace_now() : 0.0;
+        SieveThreadState& state = states[(size_t)tid];
+        if (!ready[(size_t)tid]) {   // first touch on the worker's own thread
+            state.init(ctx.wheel, ctx.seg_bits);
+            ready[(size_t)tid] = 1;
+        }
+        begin_run(state, ctx, begin, end);
+        if (tt) tt->runs++;
+
+        for (long long s = begin; s < end; s++) {
+            if (should_stop()) {
+                stopped.store(true, std::memory_order_relaxed);
+                break;
+            }
+            double seg_t0 = tt ? trace_now() : 0.0;
+            SegmentResult r = sieve_segment(state, ctx, s);
+            if (tt) tt->record_segment(trace_now() - seg_t0, r.marks, r.primes);
+            {
+                std::lock_guard<std::mutex> hold(block.lock);
+                block.done++;
+                block.primes += r.primes;
+            }
+            segments_done.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (tt) tt->region_sec += trace_now() - region_t0;
+    });
+    double sieve_sec = trace_now() - sieve_t0;
+
+    if (monitor_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> hold(monitor_lock);
+            finished = true;
+        }
+        monitor_wake.notify_one();
+        monitor_thread.join();
+    }
+
+    // Final checkpoint, also after a complete run (resuming it is free)
+    if (!job.checkpoint_path.empty() && (!save() || save_failed)) {
+        fprintf(stderr, "Could not write checkpoint %s\n", job.checkpoint_path.c_str());
+        return false;
+    }
+
+    result = JobResult();
+    result.count = ctx.even_prime_count();
+    for (JobBlock& block : blocks) {
+        result.count += block.primes;
+        result.segments_done += block.done;
+    }
+    result.num_segments = ctx.num_segments;
+    result.resumed_segments = resumed;
+    result.segments_per_sec = sieve_sec > 0 ? (double)(result.segments_done - resumed) / sieve_sec : 0.0;
+
+    trace.add_phase("job_sieve_sec", sieve_sec);
+    trace.add_param("job_segments", result.num_segments);
+    trace.add_param("job_segments_done", result.segments_done);
+    trace.add_param("job_resumed_segments", resumed);
+    trace.add_param("job_complete", result.complete() ? 1 : 0);
+    return true;
+}
+
+// Machine-readable job line (printed after the count line). While
+// complete=0 the count only covers the finished segments.
+inline void print_job_result(const JobResult& r) {
+    printf("complete=%d segments_done=%lld segments_total=%lld resumed_segments=%lld segments_per_sec=%.1f\n",
+           r.complete() ? 1 : 0, r.segments_done, r.num_segments, r.resumed_segments, r.segments_per_sec);
+}
+
+// SIGINT / SIGTERM cancel the job instead of killing the process, so the
+// final checkpoint is written
+inline CancelToken& job_cancel_token() {
+    static CancelToken token;
+    return token;
+}
+
+extern "C" inline void job_stop_signal(int) { job_cancel_token().cancel(); }
+
+inline void install_job_signal_handlers() {
+    job_cancel_token();   // construct the token before a signal can arrive
+    signal(SIGINT, job_stop_signal);
+    signal(SIGTERM, job_stop_signal);
+}
@@ -0,0 +1,515 @@
+// ============================================================
+// sieve_lmo.hpp — Combinatorial pi(x): Lagarias–Miller–Odlyzko
+// Used by sieve_serial.cpp and sieve_openmp.cpp (--method lmo)
+// Counts the primes <= x without listing them, in about x^(2/3) time
+// instead of the x log log x of the sieve:
+//   pi(x) = phi(x, a) + a - 1 - P2(x, a),   a = pi(y),  y = alpha * x^(1/3)
+// - phi(x, a) counts the n <= x with no prime factor among the first a
+//   primes. It is split into leaves n (n <= y, no square factor):
+//     S1: ordinary leaves, phi(x / n, c) for the first c <= 6 primes,
+//         read from a table of one period (PhiTiny)
+//     S2: special leaves m * p_b (m <= y < m * p_b), which need
+//         phi(x / (m * p_b), b - 1). They are counted by sieving [1, x / y]
+//         in segments, crossing off p_1, p_2, ... one prime at a time and
+//         reading the counts from a bitset with per-block counters. The
+//         easy leaves (phi reduces to a pi lookup) skip the sieve, as in
+//         Deleglise–Rivat
+// - P2(x, a) counts the n <= x with exactly two prime factors > y. It needs
+//   pi(x / p) for the primes y < p <= sqrt(x), which one range run of the
+//   shared engine over [sqrt(x), x / y] provides (any executor)
+// - S2 segments are spread over threads in waves (parallel_items). Each
+//   segment counts from 0; the counts left of it are added when the wave
+//   is combined in order, so the result does not depend on the threads.
+// The plain sieve stays the reference for the result (see README).
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+
+#include "sieve_base_primes.hpp"
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+// Below this the plain sieve is faster than building the tables
+static const long long LMO_MIN_X = 1000000;
+
+// ------------------------------------------------------------
+// phi(n, c) for the first c <= 6 primes in O(1)
+// ------------------------------------------------------------
+struct PhiTiny {
+    long long c = 0;
+    long long period = 1;      // product of the first c primes
+    long long per_period = 1;  // numbers coprime to them in one period
+    std::vector<uint16_t> up_to;   // up_to[r]: coprime numbers in [1, r]
+    std::vector<uint64_t> pattern; // bit j of the repeating words: whether 1 + j is coprime
+
+    void build(long long c_value) {
+        static const long long SMALL[6] = {2, 3, 5, 7, 11, 13};
+        c = std::min(c_value, 6LL);
+        period = 1;
+        for (long long i = 0; i < c; i++) period *= SMALL[i];
+        up_to.assign((size_t)period, 0);
+        long long coprime = 0;
+        for (long long r = 1; r < period; r++) {
+            bool keep = true;
+            for (long long i = 0; i < c; i++) keep = keep && r % SMALL[i] != 0;
+            if (keep) coprime++;
+            up_to[(size_t)r] = (uint16_t)coprime;
+        }
+        per_period = period == 1 ? 1 : coprime;
+
+        // The pattern repeats after lcm(period, 64) bits
+        long long num_words = period;
+        while (num_words % 2 == 0 && (period / num_words) < 64) num_words /= 2;
+        pattern.assign((size_t)num_words, 0);
+        for (long long j = 0; j < num_words * 64; j++) {
+            long long r = (1 + j) % period;
+            bool keep = true;
+            for (long long i = 0; i < c; i++) keep = keep && r % SMALL[i] != 0;
+            if (keep) pattern[(size_t)(j / 64)] |= 1ULL << (j % 64);
+        }
+    }
+
+    long long operator()(long long n) const {
+        return (n / period) * per_period + up_to[(size_t)(n % period)];
+    }
+};
+
+// ------------------------------------------------------------
+// Tables up to y: primes, pi, Moebius and least prime factor
+// ------------------------------------------------------------
+
+// pi(n) for n <= limit from one bit per odd number and a running count
+// per 128 numbers: 1/8 of the memory of a plain table, so the random
+// lookups of the easy leaves stay in cache
+struct LmoPiTable {
+    struct Word {
+        uint64_t odd_primes = 0;   // bit i: 128 w + 2 i + 1 is prime
+        uint64_t before = 0;       // odd primes below 128 w
+    };
+    std::vector<Word> words;
+
+    void build(const std::vector<uint32_t>& primes, long long limit) {
+        words.assign((size_t)(limit / 128 + 1), Word());
+        for (uint32_t p : primes) {
+            if ((long long)p > limit) break;
+            if (p > 2) words[p / 128].odd_primes |= 1ULL << ((p % 128) / 2);
+        }
+        uint64_t count = 0;
+        for (Word& w : words) {
+            w.before = count;
+            count += (uint64_t)__builtin_popcountll(w.odd_primes);
+        }
+    }
+
+    long long operator()(long long n) const {
+        if (n < 2) return 0;
+        long long odd = n % 2 == 0 ? n - 1 : n;
+        const Word& w = words[(size_t)(odd / 128)];
+        uint64_t mask = ~0ULL >> (63 - (odd % 128) / 2);
+        return 1 + (long long)w.before + __builtin_popcountll(w.odd_primes & mask);
+    }
+};
+
+struct LmoTables {
+    long long x = 0;
+    long long y = 0;
+    long long z = 0;                 // x / y: the S2 sieve covers [1, z]
+    long long a = 0;                 // pi(y)
+    long long c = 0;                 // primes folded into PhiTiny
+    long long pi_sqrt_y = 0;         // pi(sqrt(y))
+    std::vector<uint32_t> primes;    // primes[1] = 2, ..., primes[a] <= y (primes[0] unused)
+    LmoPiTable pi;                   // pi(n) for n <= y
+    std::vector<int32_t> mu_lpf;     // mu(n) * lpf(n) for n <= y (0: square factor), 1 -> INT32_MAX
+    PhiTiny phi_tiny;
+};
+
+// y = alpha * x^(1/3). A larger alpha shrinks the S2 and P2 sieves (x / y)
+// and grows the leaf tables; this alpha grows with log x, as in LMO's
+// analysis, and keeps y <= sqrt(x).
+inline long long lmo_choose_y(long long x) {
+    double lx = std::log((double)x);
+    double alpha = std::max(1.0, lx * lx / 60.0);
+    long long cbrt_x = (long long)std::cbrt((double)x);
+    while ((cbrt_x + 1) * (cbrt_x + 1) * (cbrt_x + 1) <= x) cbrt_x++;
+    while (cbrt_x * cbrt_x * cbrt_x > x) cbrt_x--;
+    long long y = (long long)(alpha * (double)cbrt_x);
+    return std::max(cbrt_x, std::min(y, integer_sqrt(x)));
+}
+
+inline void build_lmo_tables(long long x, const std::vector<uint32_t>& all_primes, LmoTables& t) {
+    t.x = x;
+    t.y = lmo_choose_y(x);
+    t.z = x / t.y;
+
+    t.primes.assign(1, 0);
+    for (uint32_t p : all_primes) {
+        if ((long long)p > t.y) break;
+        t.primes.push_back(p);
+    }
+    t.a = (long long)t.primes.size() - 1;
+
+    t.pi.build(all_primes, t.y);
+    t.pi_sqrt_y = t.pi(integer_sqrt(t.y));
+
+    // Sign first, then the least prime factor (the first prime to reach n)
+    t.mu_lpf.assign((size_t)t.y + 1, 1);
+    for (long long b = t.a; b >= 1; b--) {
+        long long p = t.primes[(size_t)b];
+        for (long long m = p; m <= t.y; m += p) t.mu_lpf[(size_t)m] = (int32_t)(t.mu_lpf[(size_t)m] < 0 ? p : -p);
+    }
+    for (long long b = 1; b <= t.a && t.primes[(size_t)b] <= t.y / t.primes[(size_t)b]; b++) {
+        long long square = (long long)t.primes[(size_t)b] * t.primes[(size_t)b];
+        for (long long m = square; m <= t.y; m += square) t.mu_lpf[(size_t)m] = 0;
+    }
+    t.mu_lpf[1] = INT32_MAX;
+
+    t.c = std::min(6LL, t.a);
+    t.phi_tiny.build(t.c);
+}
+
+// S1: ordinary leaves n <= y with lpf(n) > p_c
+inline long long lmo_s1(const LmoTables& t) {
+    long long pc = t.c > 0 ? t.primes[(size_t)t.c] : 1;
+    long long s1 = 0;
+    for (long long n = 1; n <= t.y; n++) {
+        int32_t v = t.mu_lpf[(size_t)n];
+        if (std::abs((long long)v) > pc) s1 += (v > 0 ? 1 : -1) * t.phi_tiny(t.x / n);
+    }
+    return s1;
+}
+
+// ------------------------------------------------------------
+// S2: special leaves, one segment [low, high) of [1, z] at a time
+// ------------------------------------------------------------
+
+// Every integer of the segment (bit i = low + i) plus the number of set
+// bits per block of 2^LMO_BLOCK_SHIFT. Crossing off is branch-free (the
+// counter drops by the bit's old value); the leaves of one prime are
+// counted left to right, so a cursor walks the counters only once.
+static const int LMO_BLOCK_SHIFT = 9;   // 512 bits per block
+
+struct LmoSegmentSieve {
+    std::vector<uint64_t> words;
+    std::vector<long long> counters;   // set bits per block
+    long long low = 0;
+    long long size = 0;
+    long long survivors = 0;       // set bits in the whole segment
+
+    // Start the segment with the first c primes already crossed off, copied
+    // from the PhiTiny pattern (low - 1 is a multiple of 64)
+    void reset(long long low_value, long long high_value, const std::vector<uint64_t>& pattern) {
+        low = low_value;
+        size = high_value - low_value;
+        size_t num_words = (size_t)((size + 63) / 64);
+        words.resize(num_words);
+        size_t k = (size_t)(((low - 1) / 64) % (long long)pattern.size());
+        for (size_t w = 0; w < num_words; w++) {
+            words[w] = pattern[k];
+            if (++k == pattern.size()) k = 0;
+        }
+        if (size % 64 != 0) words[num_words - 1] &= (1ULL << (size % 64)) - 1;
+    }
+
+    void count_blocks() {
+        size_t num_blocks = (size_t)((size + (1LL << LMO_BLOCK_SHIFT) - 1) >> LMO_BLOCK_SHIFT);
+        counters.assign(num_blocks, 0);
+        survivors = 0;
+        for (size_t w = 0; w < words.size(); w++) {
+            long long bits = __builtin_popcountll(words[w]);
+            counters[(w * 64) >> LMO_BLOCK_SHIFT] += bits;
+            survivors += bits;
+        }
+    }
+
+    // Cross off the odd multiples of an odd prime p (the even ones are gone
+    // with 2, which the pattern always holds)
+    void cross_off(long long p) {
+        long long first = (low + p - 1) / p * p;
+        if (first % 2 == 0) first += p;
+        for (long long n = first - low; n < size; n += 2 * p) {
+            uint64_t& word = words[(size_t)(n >> 6)];
+            uint64_t hit = (word >> (n & 63)) & 1;
+            word &= ~(1ULL << (n & 63));
+            survivors -= (long long)hit;
+            counters[(size_t)(n >> LMO_BLOCK_SHIFT)] -= (long long)hit;
+        }
+    }
+
+    // Survivors in [low, low + i], for i increasing along one cursor
+    struct Cursor {
+        size_t block = 0;
+        long long below = 0;   // survivors in the blocks before block
+    };
+
+    long long count_to(Cursor& cur, long long i) const {
+        size_t block = (size_t)(i >> LMO_BLOCK_SHIFT);
+        for (; cur.block < block; cur.block++) cur.below += counters[cur.block];
+        long long count = cur.below;
+        size_t w = block << (LMO_BLOCK_SHIFT - 6);
+        size_t last = (size_t)(i >> 6);
+        for (; w < last; w++) count += __builtin_popcountll(words[w]);
+        return count + __builtin_popcountll(words[last] & (~0ULL >> (63 - (i & 63))));
+    }
+};
+
+// Special leaf m * p (p > sqrt(y), m prime) with v = x / (p * m) <= y and
+// v < p^2 is easy: the numbers <= v left after crossing off the primes
+// below p are 1 and the primes in [p, v], so phi(v, b - 1) comes from the
+// pi table. These are the leaves with m > lmo_easy_m(p).
+inline long long lmo_easy_m(const LmoTables& t, long long p) {
+    return std::max(t.x / (p * (t.y + 1)), t.x / p / p / p);
+}
+
+// One segment's share of S2, counted as if nothing were left of it.
+// The real value adds leaf_sign[b] * (survivors left of the segment).
+struct LmoSegmentSums {
+    long long s2 = 0;
+    long long b_end = 0;                  // b in [c + 1, b_end) were processed
+    std::vector<long long> leaf_sign;     // sum of -mu(m) over the segment's leaves of p_b
+    std::vector<long long> survivors;     // survivors in the segment before p_b is crossed off
+};
+
+inline void lmo_s2_segment(const LmoTables& t, long long low, long long high,
+                           LmoSegmentSieve& sieve, LmoSegmentSums& out) {
+    out.s2 = 0;
+    out.leaf_sign.resize((size_t)t.a + 1);
+    out.survivors.resize((size_t)t.a + 1);
+
+    sieve.reset(low, high, t.phi_tiny.pattern);
+    sieve.count_blocks();
+
+    uint64_t ux = (uint64_t)t.x;
+    long long b = t.c + 1;
+    out.b_end = b;
+
+    // p_b <= sqrt(y): m may be composite
+    for (; b <= t.pi_sqrt_y && b < t.a; b++) {
+        long long p = t.primes[(size_t)b];
+        long long min_m = std::max((long long)(ux / ((uint64_t)p * (uint64_t)high)), t.y / p);
+        long long max_m = std::min((long long)(ux / ((uint64_t)p * (uint64_t)low)), t.y);
+        if (p >= max_m) return;
+
+        LmoSegmentSieve::Cursor cur;
+        out.leaf_sign[(size_t)b] = 0;
+        for (long long m = max_m; m > min_m; m--) {
+            int32_t v = t.mu_lpf[(size_t)m];
+            if (std::abs((long long)v) > p) {
+                long long count = sieve.count_to(cur, t.x / (p * m) - low);
+                long long sign = v > 0 ? -1 : 1;   // -mu(m)
+                out.s2 += sign * count;
+                out.leaf_sign[(size_t)b] += sign;
+            }
+        }
+        out.survivors[(size_t)b] = sieve.survivors;
+        sieve.cross_off(p);
+        out.b_end = b + 1;
+    }
+
+    // p_b > sqrt(y): m must be a prime above p_b (mu(m) = -1). The easy
+    // leaves (lmo_s2_easy) are left out, so m stops at lmo_easy_m(p_b).
+    for (; b < t.a; b++) {
+        long long p = t.primes[(size_t)b];
+        long long max_m = std::min({(long long)(ux / ((uint64_t)p * (uint64_t)low)), t.y, lmo_easy_m(t, p)});
+        long long l = t.pi(max_m);
+        long long min_m = std::max((long long)(ux / ((uint64_t)p * (uint64_t)high)), p);
+        if (p >= (long long)t.primes[(size_t)l]) return;
+
+        LmoSegmentSieve::Cursor cur;
+        out.leaf_sign[(size_t)b] = 0;
+        for (; (long long)t.primes[(size_t)l] > min_m; l--) {
+            out.s2 += sieve.count_to(cur, t.x / (p * (long long)t.primes[(size_t)l]) - low);
+            out.leaf_sign[(size_t)b]++;
+        }
+        out.survivors[(size_t)b] = sieve.survivors;
+        sieve.cross_off(p);
+        out.b_end = b + 1;
+    }
+}
+
+// The easy leaves, without sieving, as in Deleglise–Rivat. With xp = x / p
+// and v = xp / m, from the largest m down:
+// - trivial (v < p): phi = 1, all of them counted from the pi table at once
+// - clustered (m > sqrt(xp), so v < m): consecutive m often share pi(v),
+//   and each run of them is added in one step
+// - sparse: one pi(v) lookup per leaf
+inline long long lmo_s2_easy(const LmoTables& t, int num_threads) {
+    long long b_first = std::max(t.c, t.pi_sqrt_y) + 1;
+    long long num_b = std::max(0LL, t.a - b_first);
+    long long chunk = 256;
+    std::vector<long long> sums((size_t)((num_b + chunk - 1) / chunk), 0);
+
+    parallel_items((long long)sums.size(), num_threads, [&](int, long long item) {
+        long long sum = 0;
+        long long b_end = std::min(t.a, b_first + (item + 1) * chunk);
+        for (long long b = b_first + item * chunk; b < b_end; b++) {
+            long long p = t.primes[(size_t)b];
+            long long xp = t.x / p;
+            long long min_easy = std::max(p, std::min(lmo_easy_m(t, p), t.y));
+            long long min_trivial = std::max(min_easy, std::min(xp / p, t.y));
+            long long min_clustered = std::max(min_easy, std::min(integer_sqrt(xp), min_trivial));
+
+            long long l = t.pi(min_trivial);
+            sum += t.a - l;
+
+            long long l_min = t.pi(min_clustered);
+            while (l > l_min) {
+                long long phi = t.pi(xp / t.primes[(size_t)l]) - b + 2;
+                // Every m' > xp / p_(k+1), k = pi(v), has the same pi(xp / m')
+                long long l_next = std::max(l_min, (long long)t.pi(xp / t.primes[(size_t)(b + phi - 1)]));
+                sum += (l - l_next) * phi;
+                l = l_next;
+            }
+
+            l_min = t.pi(min_easy);
+            for (; l > l_min; l--) sum += t.pi(xp / t.primes[(size_t)l]) - b + 2;
+        }
+        sums[(size_t)item] = sum;
+    });
+
+    long long s2 = 0;
+    for (long long sum : sums) s2 += sum;
+    return s2;
+}
+
+// S2 = hard leaves (segmented sieve of [1, z]) + easy leaves
+inline long long lmo_s2(const LmoTables& t, int num_threads) {
+    int workers = std::max(1, num_threads);
+    long long limit = t.z + 1;
+    long long seg_size = 64;
+    while (seg_size * seg_size < limit) seg_size *= 2;
+    seg_size = std::max(seg_size, 1LL << 18);
+
+    std::vector<LmoSegmentSieve> sieves((size_t)workers);
+    std::vector<LmoSegmentSums> sums((size_t)workers);
+    std::vector<long long> phi((size_t)t.a + 1, 0);   // phi[b]: survivors left of the wave
+
+    long long s2 = 0;
+    long long num_segments = (limit - 1 + seg_size - 1) / seg_size;
+    for (long long wave = 0; wave < num_segments; wave += workers) {
+        long long wave_size = std::min((long long)workers, num_segments - wave);
+        parallel_items(wave_size, workers, [&](int tid, long long item) {
+            long long low = 1 + (wave + item) * seg_size;
+            long long high = std::min(low + seg_size, limit);
+            sums[(size_t)item].b_end = 0;
+            lmo_s2_segment(t, low, high, sieves[(size_t)tid], sums[(size_t)item]);
+        });
+
+        // Combine in segment order: each segment's leaves see the survivors left of it
+        for (long long item = 0; item < wave_size; item++) {
+            const LmoSegmentSums& r = sums[(size_t)item];
+            s2 += r.s2;
+            for (long long b = t.c + 1; b < r.b_end; b++) {
+                s2 += r.leaf_sign[(size_t)b] * phi[(size_t)b];
+                phi[(size_t)b] += r.survivors[(size_t)b];
+            }
+        }
+    }
+    return s2 + lmo_s2_easy(t, workers);
+}
+
+// ------------------------------------------------------------
+// P2: pi(x / p) for y < p <= sqrt(x), from one engine run over [sqrt(x), z]
+// ------------------------------------------------------------
+inline long long lmo_p2(const LmoTables& t, const std::vector<uint32_t>& all_primes,
+                        const SieveOptions& options, SieveTrace& trace) {
+    long long sqrt_x = integer_sqrt(t.x);
+    size_t first = (size_t)(std::upper_bound(all_primes.begin(), all_primes.end(), (uint32_t)t.y) -
+                            all_primes.begin());
+    size_t last = (size_t)(std::upper_bound(all_primes.begin(), all_primes.end(), (uint32_t)sqrt_x) -
+                           all_primes.begin());
+    if (first >= last) return 0;
+
+    // x / p lies in [sqrt(x), z]; start the range on an odd number
+    long long A = sqrt_x % 2 == 0 ? sqrt_x - 1 : sqrt_x;
+    long long primes_below_A = (long long)(std::lower_bound(all_primes.begin(), all_primes.end(), (uint32_t)A) -
+                                           all_primes.begin());
+    SieveContext ctx;
+    if (!prepare_range_context(A, t.z, options, ctx)) return -1;
+    long long sqrt_z = integer_sqrt(t.z);
+    set_base_primes(ctx, std::vector<uint32_t>(all_primes.begin(),
+                                               std::upper_bound(all_primes.begin(), all_primes.end(),
+                                                                (uint32_t)sqrt_z)));
+
+    // Bit of x / p (rounded down to odd) in the range, for p decreasing: increasing
+    std::vector<long long> bits;
+    bits.reserve(last - first);
+    for (size_t i = last; i > first; i--) {
+        long long v = t.x / all_primes[i - 1];
+        if (v % 2 == 0) v--;
+        bits.push_back((v - ctx.first_value) / 2);
+    }
+
+    std::vector<long long> seg_primes((size_t)ctx.num_segments, 0);
+    std::vector<long long> seg_leaves((size_t)ctx.num_segments, 0);
+    std::vector<long long> seg_local((size_t)ctx.num_segments, 0);
+    run_executor(ctx, options, trace, [&](int, const SieveThreadState& state, const SegmentResult& r) {
+        long long seg_first = r.seg_id * ctx.seg_bits;
+        auto begin = std::lower_bound(bits.begin(), bits.end(), seg_first);
+        auto end = std::lower_bound(begin, bits.end(), seg_first + r.num_bits);
+        long long local = 0, word_sum = 0;
+        size_t w = 0;
+        for (auto it = begin; it != end; ++it) {
+            long long i = *it - seg_first;
+            size_t word = (size_t)(i >> 6);
+            for (; w < word; w++) word_sum += __builtin_popcountll(state.segment.words[w]);
+            local += word_sum + __builtin_popcountll(state.segment.words[word] & (~0ULL >> (63 - (i & 63))));
+        }
+        seg_primes[(size_t)r.seg_id] = r.primes;
+        seg_leaves[(size_t)r.seg_id] = (long long)(end - begin);
+        seg_local[(size_t)r.seg_id] = local;
+    });
+
+    long long sum_pi = 0, primes_before = primes_below_A;
+    for (long long s = 0; s < ctx.num_segments; s++) {
+        sum_pi += seg_leaves[(size_t)s] * primes_before + seg_local[(size_t)s];
+        primes_before += seg_primes[(size_t)s];
+    }
+
+    // P2 = sum over b = a + 1 .. pi(sqrt(x)) of pi(x / p_b) - (b - 1)
+    long long b_first = (long long)first + 1, b_last = (long long)last;
+    long long minus = (b_first - 1 + b_last - 1) * (b_last - b_first + 1) / 2;
+    return sum_pi - minus;
+}
+
+// ------------------------------------------------------------
+// pi(x) and pi over [A, B]
+// ------------------------------------------------------------
+
+// pi(x) for 0 <= x < 2^63. options pick the executor, threads, wheel and
+// segment size of the engine run (P2) and the threads of S2. Returns -1 if
+// the options are invalid (unsupported wheel).
+inline long long lmo_count(long long x, const SieveOptions& options, SieveTrace& trace) {
+    if (x < LMO_MIN_X) return sieve_count(std::max(x, 0LL), options, trace);
+
+    double phase_t0 = trace_now();
+    std::vector<uint32_t> all_primes = generate_base_primes(integer_sqrt(x), options.threads);
+    LmoTables t;
+    build_lmo_tables(x, all_primes, t);
+    trace.add_phase("lmo_tables_sec", trace_now() - phase_t0);
+
+    phase_t0 = trace_now();
+    long long phi = lmo_s1(t) + lmo_s2(t, options.threads);
+    trace.add_phase("lmo_phi_sec", trace_now() - phase_t0);
+
+    phase_t0 = trace_now();
+    long long p2 = lmo_p2(t, all_primes, options, trace);
+    trace.add_phase("lmo_p2_sec", trace_now() - phase_t0);
+    if (p2 < 0) return -1;
+
+    return phi + t.a - 1 - p2;
+}
+
+// Primes in [A, B] as pi(B) - pi(A - 1)
+inline long long lmo_count_range(long long A, long long B, const SieveOptions& options, SieveTrace& trace) {
+    long long upper = lmo_count(B, options, trace);
+    if (upper < 0 || A <= 2) return upper;
+    long long lower = lmo_count(A - 1, options, trace);
+    return lower < 0 ? -1 : upper - lower;
+}
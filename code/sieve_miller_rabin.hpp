@@ -0,0 +1,212 @@
+// ============================================================
+// sieve_miller_rabin.hpp — Miller–Rabin with Montgomery multiplication
+// Used by sieve_primality.hpp (batch primality above the sieve ceiling)
+// - 64-bit: deterministic for every n < 2^64 with the 7 bases of
+//   Jim Sinclair (2, 325, 9375, 28178, 450775, 9780504, 1795265022)
+// - 128-bit: the first 13 primes as bases, deterministic for
+//   n < 3.3 * 10^24 (Sorenson & Webster); above that the first 24 primes
+//   are used and the answer is "probable prime" (error < 4^-24)
+// - Montgomery form keeps every modular multiply division-free: one
+//   wide product and one reduction (REDC). The 64-bit path multiplies in
+//   unsigned __int128; the 128-bit path builds a 256-bit product from
+//   four 64x64 -> 128 multiplies
+// - Reduction is the "subtracting" REDC (t - m*n) / R, whose result is
+//   in (-n, n), so it cannot overflow even for n close to R
+// ============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+typedef unsigned __int128 uint128_t;
+
+// Primes used for quick trial division and as Miller–Rabin bases
+static const uint32_t MR_SMALL_PRIMES[] = {2,  3,  5,  7,  11, 13, 17, 19, 23, 29, 31, 37,
+                                           41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89};
+static const int MR_NUM_SMALL_PRIMES = 24;
+
+static const uint64_t MR_BASES_64[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+static const int MR_NUM_BASES_64 = 7;
+
+// Below this bound the first 13 primes are a deterministic base set for n
+static const uint128_t MR_DETERMINISTIC_128 =
+    (uint128_t)3317044064679887ULL * 1000000000ULL + 385961981ULL;   // 3317044064679887385961981
+
+// ------------------------------------------------------------
+// 64-bit Montgomery arithmetic (R = 2^64, odd n)
+// ------------------------------------------------------------
+struct Montgomery64 {
+    uint64_t n = 1;
+    uint64_t inv = 1;    // n^-1 mod 2^64
+    uint64_t r2 = 0;     // R^2 mod n
+    uint64_t one = 0;    // R mod n (1 in Montgomery form)
+
+    explicit Montgomery64(uint64_t modulus) : n(modulus) {
+        // Newton's iteration doubles the correct low bits each step (3 -> 96)
+        inv = n;
+        for (int i = 0; i < 5; i++) inv *= 2 - n * inv;
+        one = (uint64_t)(-n) % n;
+        r2 = (uint64_t)(((uint128_t)one * one) % n);
+    }
+
+    uint64_t reduce(uint128_t t) const {
+        uint64_t m = (uint64_t)t * inv;
+        uint64_t mh = (uint64_t)(((uint128_t)m * n) >> 64);
+        uint64_t th = (uint64_t)(t >> 64);
+        return th >= mh ? th - mh : th - mh + n;
+    }
+
+    uint64_t mul(uint64_t a, uint64_t b) const { return reduce((uint128_t)a * b); }
+    uint64_t to_mont(uint64_t a) const { return mul(a % n, r2); }
+
+    uint64_t pow(uint64_t base_m, uint64_t e) const {
+        uint64_t result = one;
+        while (e > 0) {
+            if (e & 1) result = mul(result, base_m);
+            base_m = mul(base_m, base_m);
+            e >>= 1;
+        }
+        return result;
+    }
+};
+
+// ------------------------------------------------------------
+// 128-bit Montgomery arithmetic (R = 2^128, odd n)
+// ------------------------------------------------------------
+
+// Full 256-bit product a * b as (hi, lo)
+inline void mul_wide_128(uint128_t a, uint128_t b, uint128_t& hi, uint128_t& lo) {
+    uint64_t a0 = (uint64_t)a, a1 = (uint64_t)(a >> 64);
+    uint64_t b0 = (uint64_t)b, b1 = (uint64_t)(b >> 64);
+    uint128_t p00 = (uint128_t)a0 * b0;
+    uint128_t p01 = (uint128_t)a0 * b1;
+    uint128_t p10 = (uint128_t)a1 * b0;
+    uint128_t p11 = (uint128_t)a1 * b1;
+
+    uint128_t mid = (p00 >> 64) + (uint64_t)p01 + (uint64_t)p10;   // < 3 * 2^64
+    lo = (mid << 64) | (uint64_t)p00;
+    hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+// High 128 bits of a * b
+inline uint128_t mul_high_128(uint128_t a, uint128_t b) {
+    uint128_t hi, lo;
+    mul_wide_128(a, b, hi, lo);
+    return hi;
+}
+
+struct Montgomery128 {
+    uint128_t n = 1;
+    uint128_t inv = 1;   // n^-1 mod 2^128
+    uint128_t r2 = 0;    // R^2 mod n
+    uint128_t one = 0;   // R mod n
+
+    explicit Montgomery128(uint128_t modulus) : n(modulus) {
+        inv = n;
+        for (int i = 0; i < 6; i++) inv *= 2 - n * inv;
+        one = (uint128_t)(-n) % n;
+
+        // R^2 mod n by doubling R mod n another 128 times (no 256-bit division)
+        r2 = one;
+        for (int i = 0; i < 128; i++) r2 = add(r2, r2);
+    }
+
+    uint128_t add(uint128_t a, uint128_t b) const {
+        uint128_t s = a + b;
+        return (s < a || s >= n) ? s - n : s;   // a carry past 2^128 means s + 2^128 >= n
+    }
+
+    uint128_t reduce(uint128_t hi, uint128_t lo) const {
+        uint128_t m = lo * inv;
+        uint128_t mh = mul_high_128(m, n);
+        return hi >= mh ? hi - mh : hi - mh + n;
+    }
+
+    uint128_t mul(uint128_t a, uint128_t b) const {
+        uint128_t hi, lo;
+        mul_wide_128(a, b, hi, lo);
+        return reduce(hi, lo);
+    }
+
+    uint128_t to_mont(uint128_t a) const { return mul(a % n, r2); }
+
+    uint128_t pow(uint128_t base_m, uint128_t e) const {
+        uint128_t result = one;
+        while (e > 0) {
+            if (e & 1) result = mul(result, base_m);
+            base_m = mul(base_m, base_m);
+            e >>= 1;
+        }
+        return result;
+    }
+};
+
+// ------------------------------------------------------------
+// Strong probable-prime test to one base, n odd, n - 1 = d * 2^s
+// ------------------------------------------------------------
+template <typename Mont, typename U>
+bool strong_probable_prime(const Mont& mont, U base, U d, int s) {
+    U minus_one = mont.n - mont.one;   // n - 1 in Montgomery form
+    U x = mont.pow(mont.to_mont(base), d);
+    if (x == mont.one || x == minus_one) return true;
+    for (int r = 1; r < s; r++) {
+        x = mont.mul(x, x);
+        if (x == minus_one) return true;
+        if (x == mont.one) return false;
+    }
+    return false;
+}
+
+// Trial division by the small primes. Returns 1 (prime), 0 (composite)
+// or -1 (no small factor, needs Miller–Rabin)
+template <typename U>
+int small_prime_check(U n) {
+    if (n < 2) return 0;
+    for (int i = 0; i < MR_NUM_SMALL_PRIMES; i++) {
+        U p = MR_SMALL_PRIMES[i];
+        if (n == p) return 1;
+        if (n % p == 0) return 0;
+    }
+    return n < 89 * 89 ? 1 : -1;
+}
+
+// Deterministic primality for any 64-bit n
+inline bool is_prime_u64(uint64_t n) {
+    int quick = small_prime_check(n);
+    if (quick >= 0) return quick == 1;
+
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+
+    Montgomery64 mont(n);
+    for (int i = 0; i < MR_NUM_BASES_64; i++) {
+        uint64_t a = MR_BASES_64[i] % n;
+        if (a == 0) continue;   // base is a multiple of n: says nothing
+        if (!strong_probable_prime(mont, a, d, s)) return false;
+    }
+    return true;
+}
+
+// Primality for a 128-bit n: deterministic below MR_DETERMINISTIC_128,
+// probable prime above it. 64-bit values take the faster 64-bit path.
+inline bool is_prime_u128(uint128_t n) {
+    if ((n >> 64) == 0) return is_prime_u64((uint64_t)n);
+    int quick = small_prime_check(n);
+    if (quick >= 0) return quick == 1;
+
+    uint128_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    Montgomery128 mont(n);
+    int num_bases = n < MR_DETERMINISTIC_128 ? 13 : MR_NUM_SMALL_PRIMES;
+    for (int i = 0; i < num_bases; i++) {
+        if (!strong_probable_prime(mont, (uint128_t)MR_SMALL_PRIMES[i], d, s)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+// ============================================================
+// sieve_mmap.hpp — Minimal memory-mapped file wrapper (POSIX)
+// Used by the binary output writer/reader (sieve_output.hpp)
+// - create(): new file of a fixed size, mapped read/write and shared,
+//   so stores from any thread land directly in the page cache
+// - open_read(): existing file mapped read-only
+// - The mapping is released (and the file closed) by close() or the
+//   destructor; dirty pages are written back by the kernel
+// ============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SIEVE_HAVE_MMAP 1
+#else
+#define SIEVE_HAVE_MMAP 0
+#endif
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // Create (or truncate) path with exactly size bytes and map it read/write.
+    // Returns false if the file cannot be created, sized or mapped.
+    bool create(const std::string& path, size_t size) {
+        close();
+#if SIEVE_HAVE_MMAP
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) return false;
+        if (::ftruncate(fd_, (off_t)size) != 0) { close(); return false; }
+        return map(size, PROT_READ | PROT_WRITE);
+#else
+        (void)path; (void)size;
+        return false;
+#endif
+    }
+
+    // Map an existing file read-only. Returns false if it cannot be opened.
+    bool open_read(const std::string& path) {
+        close();
+#if SIEVE_HAVE_MMAP
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) { close(); return false; }
+        return map((size_t)st.st_size, PROT_READ);
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void close() {
+#if SIEVE_HAVE_MMAP
+        if (data_ != nullptr && size_ > 0) ::munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        fd_ = -1;
+    }
+
+    uint8_t* data() { return static_cast<uint8_t*>(data_); }
+    const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+    size_t size() const { return size_; }
+    bool is_open() const { return fd_ >= 0; }
+
+private:
+#if SIEVE_HAVE_MMAP
+    bool map(size_t size, int prot) {
+        size_ = size;
+        if (size == 0) return true;  // nothing to map; data() stays null
+        void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        data_ = p;
+        return true;
+    }
+#endif
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+};
@@ -0,0 +1,226 @@
+// ============================================================
+// sieve_mpi.cpp — Distributed (MPI) Segmented Sieve
+// Runs the shared engine (see sieve_engine.hpp) on every rank
+// PCAM:
+// - Partition: the segments of [3..N] (or [A..B]) are split into one
+//   contiguous slice per rank, on segment boundaries
+// - Communication: rank 0 computes the base primes up to sqrt(N) once
+//   and broadcasts them; counts come back through one MPI_Reduce
+// - Agglomeration: inside a rank the slice is sieved by a shared-memory
+//   executor (openmp if built with OpenMP, pool otherwise) with
+//   <threads> threads
+// - Mapping: one rank per node (or per socket) with threads = its cores
+// Usage: mpirun -np <ranks> ./sieve_mpi <N> <threads> [--executor <name>] [...]
+//        mpirun -np <ranks> ./sieve_mpi --range <A> <B> <threads> [...]
+// Same flags as sieve_openmp, except --output and --cache (each rank
+// would need its own file). --print sends every rank's primes to rank 0,
+// which prints them in order.
+// Build with -DSIEVE_VERBOSE=1 for per-rank console output
+// Output: N=<N> ranks=<R> threads=<T> count=<count> time_sec=<time>
+//         A=<A> B=<B> ranks=<R> threads=<T> count=<count> time_sec=<time>   (range mode)
+// ============================================================
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <mpi.h>
+
+#include "sieve_executors.hpp"
+#include "sieve_stream.hpp"
+#include "sieve_cli.hpp"
+
+using namespace std;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+// Message tag for blocks of primes sent to rank 0 by --print
+static const int PRIME_BLOCK_TAG = 1;
+
+// ------------------------------------------------------------
+// Step 1: Each rank's slice of the segments
+// ------------------------------------------------------------
+struct RankSlice {
+    long long first_segment = 0;
+    long long end_segment = 0;   // one past the last segment
+    long long A = 0;             // slice as a range [A, B] for build_range_context
+    long long B = 0;
+
+    bool empty() const { return first_segment >= end_segment; }
+};
+
+// Split the segments of global evenly: rank r gets [S*r/R, S*(r+1)/R).
+// Rank 0 keeps the original lower end so it also counts the prime 2.
+RankSlice plan_rank_slice(const SieveContext& global, int rank, int ranks) {
+    RankSlice slice;
+    slice.first_segment = global.num_segments * rank / ranks;
+    slice.end_segment = global.num_segments * (rank + 1) / ranks;
+    if (slice.empty()) return slice;
+
+    slice.A = (rank == 0) ? global.A : global.segment_low(slice.first_segment);
+    slice.B = global.segment_high(slice.end_segment - 1);
+    return slice;
+}
+
+// ------------------------------------------------------------
+// Step 2: Base primes computed on rank 0, broadcast to every rank
+// ------------------------------------------------------------
+vector<uint32_t> broadcast_base_primes(const SieveContext& global, const SieveOptions& options,
+                                       int rank, SieveTrace& trace) {
+    vector<uint32_t> primes;
+    double phase_t0 = trace_now();
+    if (rank == 0) primes = generate_base_primes(integer_sqrt(global.N), options.threads);
+    trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+
+    phase_t0 = trace_now();
+    long long count = (long long)primes.size();
+    MPI_Bcast(&count, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    primes.resize((size_t)count);
+    MPI_Bcast(primes.data(), (int)count, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+    trace.add_phase("broadcast_sec", trace_now() - phase_t0);
+    return primes;
+}
+
+// ------------------------------------------------------------
+// Step 3: --print. Rank 0 prints its own slice, then the blocks of
+// ranks 1, 2, ... in rank order; an empty block ends a rank's stream.
+// ------------------------------------------------------------
+long long print_slice(const SieveContext& ctx, const RankSlice& slice, const SieveOptions& options,
+                      int rank, SieveTrace& trace) {
+    long long count = 0;
+    if (rank == 0) {
+        if (!slice.empty()) count = stream_primes(ctx, options, trace, print_prime_block);
+        return count;
+    }
+
+    // The stream sink runs on one worker thread at a time (MPI_THREAD_SERIALIZED)
+    auto send_block = [](const long long* primes, size_t n) {
+        MPI_Send(primes, (int)n, MPI_LONG_LONG, 0, PRIME_BLOCK_TAG, MPI_COMM_WORLD);
+    };
+    if (!slice.empty()) count = stream_primes(ctx, options, trace, send_block);
+    MPI_Send(nullptr, 0, MPI_LONG_LONG, 0, PRIME_BLOCK_TAG, MPI_COMM_WORLD);
+    return count;
+}
+
+void print_other_ranks(int ranks) {
+    vector<long long> block;
+    for (int source = 1; source < ranks; source++) {
+        for (;;) {
+            MPI_Status status;
+            MPI_Probe(source, PRIME_BLOCK_TAG, MPI_COMM_WORLD, &status);
+            int n = 0;
+            MPI_Get_count(&status, MPI_LONG_LONG, &n);
+            block.resize((size_t)n);
+            MPI_Recv(block.data(), n, MPI_LONG_LONG, source, PRIME_BLOCK_TAG, MPI_COMM_WORLD,
+                     MPI_STATUS_IGNORE);
+            if (n == 0) break;
+            print_prime_block(block.data(), (size_t)n);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    int rank = 0, ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    SieveArgs args;
+    args.N = 1000000000LL;
+    args.options.threads = 1;
+#ifdef _OPENMP
+    args.options.executor = SieveExecutor::OpenMP;
+#else
+    args.options.executor = SieveExecutor::ThreadPool;
+#endif
+
+    // Every rank parses the same argv; only rank 0 reports problems
+    bool ok = parse_sieve_args(argc, argv, true, args);
+    if (ok && (!args.output_path.empty() || !args.cache_path.empty() || args.method != CountMethod::Sieve ||
+              args.stats || args.job_mode())) {
+        if (rank == 0) fprintf(stderr, "--output, --cache, --method lmo, --stats and jobs (--checkpoint, --deadline, "
+                                       "--progress) are not supported by sieve_mpi\n");
+        ok = false;
+    }
+    if (ok && args.print_primes && ranks > 1 && provided < MPI_THREAD_SERIALIZED) {
+        if (rank == 0) fprintf(stderr, "--print needs an MPI library with MPI_THREAD_SERIALIZED\n");
+        ok = false;
+    }
+    if (!ok) {
+        MPI_Finalize();
+        return 1;
+    }
+    if (args.options.threads < 1) args.options.threads = 1;
+
+    // Only rank 0 keeps a trace (its own threads plus the shared phases)
+    SieveTrace trace;
+    if (rank == 0 && !args.trace_path.empty()) trace.enable(args.options.threads);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+
+    // Global geometry is cheap, so every rank builds it instead of receiving it
+    SieveContext global;
+    prepare_range_context(args.range ? args.A : 0, args.N, args.options, global);
+    vector<uint32_t> primes = broadcast_base_primes(global, args.options, rank, trace);
+
+    // Slices reuse the global segment size, so their segments line up with the global ones
+    RankSlice slice = plan_rank_slice(global, rank, ranks);
+    SieveOptions slice_options = args.options;
+    slice_options.segment_bytes = global.segment_bytes;
+
+    SieveContext ctx;
+    long long local_count = 0;
+    double sieve_t0 = MPI_Wtime();
+    if (!slice.empty()) {
+        prepare_range_context(slice.A, slice.B, slice_options, ctx);
+        set_base_primes(ctx, primes);
+    }
+    if (rank == 0 && slice.empty()) {
+        // No segment for rank 0 (tiny N): the prime 2 is still its to count
+        local_count = global.even_prime_count();
+        if (args.print_primes) print_even_prime(global);
+    }
+    if (args.print_primes) {
+        local_count += print_slice(ctx, slice, slice_options, rank, trace);
+    } else if (!slice.empty()) {
+        local_count = run_executor(ctx, slice_options, trace, NoSegmentVisitor());
+    }
+    double sieve_sec = MPI_Wtime() - sieve_t0;
+
+    if constexpr (VERBOSE) {
+        printf("rank %d: segments [%lld, %lld) range [%lld, %lld] count=%lld sieve_sec=%.6f\n",
+               rank, slice.first_segment, slice.end_segment, slice.A, slice.B, local_count,
+               sieve_sec);
+    }
+
+    // Step 4: Sum the per-rank counts on rank 0
+    if (rank == 0 && args.print_primes) print_other_ranks(ranks);
+    long long count = 0;
+    MPI_Reduce(&local_count, &count, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    // Slowest rank's sieve time (load balance check for the trace)
+    double max_sieve_sec = 0;
+    MPI_Reduce(&sieve_sec, &max_sieve_sec, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    double elapsed = MPI_Wtime() - t0;
+
+    if (rank == 0) {
+        trace.add_param("ranks", ranks);
+        trace.add_phase("max_rank_sieve_sec", max_sieve_sec);
+        finish_trace(trace, args, global, count, elapsed);
+
+        if (args.range) {
+            printf("A=%lld B=%lld ranks=%d threads=%d count=%lld time_sec=%.6f\n",
+                   args.A, args.N, ranks, args.options.threads, count, elapsed);
+        } else {
+            printf("N=%lld ranks=%d threads=%d count=%lld time_sec=%.6f\n",
+                   args.N, ranks, args.options.threads, count, elapsed);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,172 @@
+// ============================================================
+// sieve_numa.hpp — NUMA topology, thread placement and pinning
+// Used by the numa executor (run_numa in sieve_executors.hpp)
+// - Nodes and their CPUs come from /sys/devices/system/node/node*/cpulist,
+//   restricted to the CPUs this process may run on (sched_getaffinity);
+//   without that information everything is one node
+// - Threads are spread over the nodes in proportion to each node's CPUs
+//   and pinned to one CPU each (sched_setaffinity)
+// - Memory placement relies on the kernel's default first-touch policy:
+//   data written first by a pinned thread lands on that thread's node,
+//   so no libnuma is needed
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;   // CPUs of this node that the process may use
+};
+
+struct NumaTopology {
+    std::vector<NumaNode> nodes;
+
+    int total_cpus() const {
+        int total = 0;
+        for (const NumaNode& n : nodes) total += (int)n.cpus.size();
+        return total;
+    }
+};
+
+// Parse a kernel CPU list such as "0-3,8-11,16"
+inline std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t end = text.find(',', i);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(i, end - i);
+        int first = 0, last = 0;
+        if (sscanf(item.c_str(), "%d-%d", &first, &last) == 2) {
+            for (int c = first; c <= last; c++) cpus.push_back(c);
+        } else if (sscanf(item.c_str(), "%d", &first) == 1) {
+            cpus.push_back(first);
+        }
+        i = end + 1;
+    }
+    return cpus;
+}
+
+// CPUs the process is allowed to run on (empty if unknown)
+inline std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+#endif
+    return cpus;
+}
+
+inline NumaTopology detect_numa_topology() {
+    NumaTopology topo;
+    std::vector<int> allowed = allowed_cpus();
+
+    // Node ids can have holes; stop after a long run of missing nodes
+    for (int node = 0, missing = 0; missing < 64; node++) {
+        std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f) { missing++; continue; }
+        missing = 0;
+
+        char buf[4096] = {0};
+        size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        buf[len] = '\0';
+
+        NumaNode n;
+        n.id = node;
+        for (int c : parse_cpu_list(buf)) {
+            if (allowed.empty() || std::find(allowed.begin(), allowed.end(), c) != allowed.end()) {
+                n.cpus.push_back(c);
+            }
+        }
+        if (!n.cpus.empty()) topo.nodes.push_back(n);
+    }
+
+    // No sysfs (or no usable node): one node holding every allowed CPU
+    if (topo.nodes.empty()) {
+        NumaNode n;
+        n.cpus = allowed;
+        if (n.cpus.empty()) {
+            int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+            for (int c = 0; c < hw; c++) n.cpus.push_back(c);
+        }
+        topo.nodes.push_back(n);
+    }
+    return topo;
+}
+
+// Where each worker thread runs: index into topo.nodes and a CPU to pin to
+struct ThreadPlacement {
+    int node_index = 0;
+    int cpu = -1;
+};
+
+// Spread num_threads over the nodes in proportion to their CPU counts
+// (every node with CPUs gets at least one thread while threads last).
+// Threads of a node are consecutive and use the node's CPUs in order;
+// with more threads than CPUs they wrap around.
+inline std::vector<ThreadPlacement> plan_thread_placement(const NumaTopology& topo, int num_threads) {
+    int num_nodes = (int)topo.nodes.size();
+    int total = std::max(1, topo.total_cpus());
+
+    std::vector<int> per_node((size_t)num_nodes, 0);
+    int assigned = 0;
+    for (int n = 0; n < num_nodes; n++) {
+        per_node[(size_t)n] = (int)((long long)num_threads * (long long)topo.nodes[(size_t)n].cpus.size() / total);
+        assigned += per_node[(size_t)n];
+    }
+    // Hand out the remainder, empty nodes first, then the largest nodes
+    while (assigned < num_threads) {
+        int best = 0;
+        for (int n = 1; n < num_nodes; n++) {
+            bool empty_n = per_node[(size_t)n] == 0, empty_best = per_node[(size_t)best] == 0;
+            long long spare_n = (long long)topo.nodes[(size_t)n].cpus.size() - per_node[(size_t)n];
+            long long spare_best = (long long)topo.nodes[(size_t)best].cpus.size() - per_node[(size_t)best];
+            if ((empty_n && !empty_best) || (empty_n == empty_best && spare_n > spare_best)) best = n;
+        }
+        per_node[(size_t)best]++;
+        assigned++;
+    }
+
+    std::vector<ThreadPlacement> placement;
+    for (int n = 0; n < num_nodes; n++) {
+        const std::vector<int>& cpus = topo.nodes[(size_t)n].cpus;
+        for (int i = 0; i < per_node[(size_t)n]; i++) {
+            ThreadPlacement p;
+            p.node_index = n;
+            p.cpu = cpus.empty() ? -1 : cpus[(size_t)i % cpus.size()];
+            placement.push_back(p);
+        }
+    }
+    return placement;
+}
+
+// Pin the calling thread to one CPU. Returns false if pinning is unavailable.
+inline bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -0,0 +1,99 @@
+// ============================================================
+// sieve_offsets.hpp — Persistent "next multiple" state for base primes
+// Shared by sieve_serial.cpp and sieve_openmp.cpp
+// - For every small/medium base prime p we remember the bit index of its
+//   next odd multiple, relative to the start of the current segment
+// - After a segment is marked the index is simply shifted down by the
+//   segment length and carried into the next segment, so the first
+//   multiple is found with one division per prime per run of segments
+//   instead of one division per prime per segment
+// - Primes become active once p^2 reaches the current segment; until then
+//   they would start past the segment anyway
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "sieve_bitset.hpp"
+
+// Bit index (relative to the odd number low) of the first odd multiple of
+// the odd prime p that is >= low. Works on offsets only, so low close to
+// 2^63 cannot overflow.
+inline long long first_odd_multiple_index(long long low, long long p) {
+    long long offset = (p - low % p) % p;
+    if (offset % 2 != 0) offset += p;  // low + offset must stay odd
+    return offset / 2;
+}
+
+class SmallPrimeOffsets {
+public:
+    // Prepare offsets for primes[first..last) for a contiguous run of segments
+    // whose first segment starts at the odd number run_low.
+    // primes must stay alive (and unchanged) while the run is being sieved.
+    void init(const std::vector<uint32_t>& primes, size_t first, size_t last, long long run_low) {
+        primes_ = &primes;
+        first_ = first;
+        last_ = last;
+
+        size_t count = last > first ? last - first : 0;
+        if (next_.size() < count) next_.resize(count);
+
+        // Primes with p^2 <= run_low are active from the first segment on:
+        // find their first odd multiple >= run_low with one division each
+        active_end_ = first;
+        while (active_end_ < last) {
+            long long p = primes[active_end_];
+            if (p * p > run_low) break;
+
+            next_[active_end_ - first] = (uint32_t)first_odd_multiple_index(run_low, p);
+            active_end_++;
+        }
+    }
+
+    // Cross off multiples of all active primes in seg, then carry each prime's
+    // next index into the following segment. Segments must be fed in order,
+    // each one starting right after the previous. Returns the number of bits cleared.
+    long long sieve_segment(SegmentBitset& seg) {
+        long long low = seg.low;
+        long long high = low + 2 * (seg.num_bits - 1);
+
+        // Activate primes whose square has come into range: first hit is p^2
+        while (active_end_ < last_) {
+            long long p = (*primes_)[active_end_];
+            if (p * p > high) break;
+            next_[active_end_ - first_] = (uint32_t)((p * p - low) / 2);
+            active_end_++;
+        }
+
+        long long num_bits = seg.num_bits;
+        long long marks = 0;
+
+        for (size_t i = first_; i < active_end_; i++) {
+            long long p = (*primes_)[i];
+            long long idx = next_[i - first_];
+
+            for (; idx < num_bits; idx += p) {
+                seg.clear(idx);
+                marks++;
+            }
+
+            // idx is now the first multiple past this segment
+            next_[i - first_] = (uint32_t)(idx - num_bits);
+        }
+
+        return marks;
+    }
+
+    // Number of primes currently being marked
+    size_t active_count() const { return active_end_ - first_; }
+
+private:
+    const std::vector<uint32_t>* primes_ = nullptr;
+    std::vector<uint32_t> next_;
+    size_t first_ = 0;
+    size_t last_ = 0;
+    size_t active_end_ = 0;
+};
@@ -2,233 +2,117 @@
 // sieve_openmp.cpp — OpenMP Parallel Segmented Sieve (Beginner-Friendly)
 // Shared-memory parallel version
 // PCAM: Range partitioned across threads; base primes shared read-only
+// All sieving is done by the shared engine (see sieve_engine.hpp);
+// this driver picks a parallel executor (see sieve_executors.hpp):
+//   openmp (default) — OpenMP team, runs of segments with schedule(dynamic)
+//   pool             — std::thread workers pulling runs from an atomic counter
+//   numa             — pinned threads, per-node copies of base primes and
+//                      wheel, segment range split by NUMA node
+//   steal            — one contiguous block per thread, idle threads steal
+//                      the back half of the largest remaining block
+//   pipeline         — sieve threads pass finished bitmaps to a consumer
+//                      thread (e.g. --print) so output overlaps sieving
+//   serial           — single worker, for comparison
+// Usage: ./sieve_openmp <N> <threads> [--wheel <modulus>] [--segment-bytes <B>]
+//                      [--executor openmp|pool|numa|steal|pipeline|serial] [--trace <file.json>]
+//                      [--presieve <limit>] [--simd auto|scalar|avx2|avx512]
+//        ./sieve_openmp --range <A> <B> <threads> [...]   primes in [A, B] only
+// --print writes every prime in order through the streaming API
+// (sieve_stream.hpp), whichever executor is used
+// --output <file> [--output-format bitmap|gaps] writes a binary file; each
+// thread fills its segments' slots in the memory-mapped file directly
+// --cache <file> answers from a prime cache, building it on a miss
+// --method lmo counts with the combinatorial pi(x) of sieve_lmo.hpp in
+// about N^(2/3) time instead of sieving (count only; same output line)
+// --stats adds a second line from the same pass (sieve_stats.hpp):
+//         twins=<n> cousins=<n> sexy=<n> triplets=<n> quadruplets=<n>
+//         max_gap=<gap> max_gap_start=<p>
+// --checkpoint <file> [--checkpoint-every <s>] [--deadline <s>] [--progress <s>]
+// counts as a resumable job (sieve_job.hpp) and adds a second line:
+//         complete=<0|1> segments_done=<n> segments_total=<n>
+//         resumed_segments=<n> segments_per_sec=<rate>
+// A stopped job (deadline, Ctrl-C, SIGTERM) exits with status 2 and its
+// count covers only the finished segments; run it again to resume
+// Build with -DSIEVE_VERBOSE=1 for step-by-step console output
 // Output: N=<N> threads=<T> count=<count> time_sec=<time>
+//         A=<A> B=<B> threads=<T> count=<count> time_sec=<time>   (range mode)
 // ============================================================
 
 #include <iostream>
 #include <vector>
-#include <cmath>
 #include <chrono>
-#include <cstdlib>
 #include <cstdio>
 #include <algorithm>
 #include <omp.h>
 
+#include "sieve_executors.hpp"
+#include "sieve_lmo.hpp"
+#include "sieve_stats.hpp"
+#include "sieve_stream.hpp"
+#include "sieve_cli.hpp"
+
 using namespace std;
 using namespace chrono;
 
-// Segment size (numbers, not just odds)
-// You can tune this later for performance experiments
-static const long long SEG_SIZE = 1 << 20; // ~1M numbers per segment
-
-// Toggle verbose prints here (true = learning/debugging, false = benchmarking)
-static const bool VERBOSE = true;
+// Verbose prints (learning/debugging) are compiled in only with -DSIEVE_VERBOSE=1;
+// benchmark builds drop them, including every critical section, at compile time
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
 
 // ------------------------------------------------------------
-// Step 1: Sequential simple sieve up to sqrt(N)
-// Returns list of base primes
+// Step 1: Show the setup built by the engine (sequential part)
 // ------------------------------------------------------------
-vector<int> simple_sieve(int limit) {
-    if (VERBOSE) {
-        cout << "\nStarting simple_sieve(limit = " << limit << ")" << endl;
-    }
-
-    vector<bool> is_prime(limit + 1, true);
-
-    if (limit >= 0) is_prime[0] = false;
-    if (limit >= 1) is_prime[1] = false;
-
-    for (int i = 2; (long long)i * i <= limit; i++) {
-        if (is_prime[i]) {
-            if (VERBOSE && i <= 20) {
-                cout << "Found base prime " << i
-                     << ". Marking multiples starting at " << (1LL * i * i) << "." << endl;
-            }
-
-            for (long long j = 1LL * i * i; j <= limit; j += i) {
-                is_prime[(int)j] = false;
-            }
-        }
-    }
-
-    vector<int> primes;
-    for (int i = 2; i <= limit; i++) {
-        if (is_prime[i]) primes.push_back(i);
-    }
-
-    if (VERBOSE) {
-        cout << "simple_sieve complete. Number of base primes = " << primes.size() << endl;
-        cout << "First few base primes: ";
-        for (size_t i = 0; i < primes.size() && i < 15; i++) {
-            cout << primes[i] << (i + 1 < primes.size() && i < 14 ? ", " : "");
-        }
-        cout << endl;
-    }
-
-    return primes;
+void print_context(const SieveContext& ctx, const SieveOptions& options) {
+    cout << "Computed parameters:" << endl;
+    if (ctx.A > 0) cout << "  range = [" << ctx.A << ", " << ctx.N << "]" << endl;
+    cout << "  base primes up to sqrt(N) = " << ctx.base_primes.size() << endl;
+    cout << "  first_value = " << ctx.first_value << endl;
+    cout << "  segment size = " << ctx.seg_size << " numbers (" << ctx.segment_bytes << " bytes)" << endl;
+    cout << "  wheel modulus = " << ctx.wheel.modulus << endl;
+    cout << "  pre-sieved primes up to " << ctx.wheel.largest_prime()
+         << " (simd = " << simd_level_name(simd_kernels().level) << ")" << endl;
+    cout << "  num_segments = " << ctx.num_segments << endl;
+    cout << "  large (bucketed) base primes = " << (ctx.base_primes.size() - ctx.first_large) << endl;
+    cout << "  segments per run = " << plan_run_length(ctx, options.threads, options.max_run_segments) << endl;
+    cout << "  executor = " << executor_name(options.executor) << endl;
 }
 
 // ------------------------------------------------------------
-// Step 2: OpenMP parallel segmented sieve over [2..N]
-// - Base primes computed once (sequential)
-// - Segments distributed across threads
-// - Each thread uses its own local segment buffer
+// Step 2: Parallel segmented sieve over [2..N]
+// - Base primes computed once (sequential, shared read-only)
+// - Contiguous runs of segments distributed across threads
+// - Each thread allocates its segment buffer, buckets and offsets once
+//   (see sieve_arena.hpp) and reuses them for every run
 // ------------------------------------------------------------
-long long sieve_openmp(long long N, int num_threads) {
-    if (N < 2) return 0;
-
-    omp_set_num_threads(num_threads);
-
-    if (VERBOSE) {
-        cout << "\nStarting sieve_openmp(N = " << N
-             << ", num_threads = " << num_threads << ")" << endl;
-    }
-
-    // Count prime 2 separately (odd-only segment representation later)
-    long long total_count = 1; // prime = 2
-
-    // Base primes up to sqrt(N), computed once
-    int limit = (int)floor(sqrt((long double)N));
-    vector<int> base_primes = simple_sieve(limit);
-
-    // Number of segments for [3..N]
-    long long first_value = 3;
-    if (first_value > N) return total_count;
-
-    long long total_numbers = N - first_value + 1;
-    long long num_segments = (total_numbers + SEG_SIZE - 1) / SEG_SIZE;
-
-    if (VERBOSE) {
-        cout << "Computed parameters:" << endl;
-        cout << "  floor(sqrt(N)) = " << limit << endl;
-        cout << "  first_value = " << first_value << endl;
-        cout << "  total_numbers = " << total_numbers << endl;
-        cout << "  SEG_SIZE = " << SEG_SIZE << endl;
-        cout << "  num_segments = " << num_segments << endl;
-        cout << "Starting OpenMP parallel loop over segments..." << endl;
-    }
-
-    // Parallelize over segments
-    // dynamic scheduling helps load balancing if segments vary
-    #pragma omp parallel for schedule(dynamic) reduction(+:total_count)
-    for (long long seg_id = 0; seg_id < num_segments; seg_id++) {
-        int tid = omp_get_thread_num();
-
-        long long low  = first_value + seg_id * SEG_SIZE;
-        long long high = min(low + SEG_SIZE - 1, N);
-
-        // Make low odd (we store only odd numbers)
-        if (low % 2 == 0) low++;
-
-        // If segment became invalid after adjusting, skip
-        if (low > high) {
-            if (VERBOSE) {
-                #pragma omp critical
-                {
-                    cout << "Thread " << tid
-                         << " skipped segment " << seg_id
-                         << " because low > high after odd adjustment." << endl;
-                }
-            }
-            continue;
-        }
-
-        // Number of odd values in [low..high]
-        long long odd_count = ((high - low) / 2) + 1;
-
-        if (VERBOSE) {
-            #pragma omp critical
-            {
-                cout << "Thread " << tid
-                     << " processing segment " << seg_id
-                     << " with range [" << low << ", " << high << "]"
-                     << " (odd_count = " << odd_count << ")" << endl;
-            }
-        }
-
-        // Local segment buffer (thread-local because created inside loop)
-        vector<bool> segment((size_t)odd_count, true);
-
-        // Mark composites in this segment using base primes
-        int printed_mark_actions = 0; // limit prints per segment
-
-        for (int p : base_primes) {
-            if (p == 2) continue; // segment stores only odd numbers
-
-            long long p64 = (long long)p;
-            long long p2  = p64 * p64;
-
-            // If p^2 > high, no need to continue for this segment
-            if (p2 > high) break;
-
-            // First multiple of p within [low..high]
-            long long start = max(p2, ((low + p64 - 1) / p64) * p64);
-
-            // Ensure start is odd (segment stores odd numbers only)
-            if ((start % 2) == 0) start += p64;
-
-            if (VERBOSE && seg_id < 2 && p <= 19) {
+long long sieve_openmp(const SieveContext& ctx, const SieveOptions& options, SieveTrace& trace) {
+    auto report = [](int tid, const SieveThreadState& state, const SegmentResult& r) {
+        if constexpr (VERBOSE) {
+            if (r.seg_id < 2) {
                 #pragma omp critical
                 {
                     cout << "Thread " << tid
-                         << " | Segment " << seg_id
-                         << " | Using prime p = " << p
-                         << " | p^2 = " << p2
-                         << " | first odd multiple = " << start
-                         << " | step = " << (2 * p64) << endl;
-                }
-            }
-
-            // Mark odd multiples only (step = 2p)
-            for (long long x = start; x <= high; x += 2 * p64) {
-                long long idx = (x - low) / 2;
-                segment[(size_t)idx] = false;
-
-                // Print only a few actual mark actions (to avoid huge output)
-                if (VERBOSE && seg_id < 1 && printed_mark_actions < 12) {
-                    #pragma omp critical
-                    {
-                        cout << "Thread " << tid
-                             << " marked composite number " << x
-                             << " (segment index " << idx << ") using prime " << p << endl;
+                         << " finished segment " << r.seg_id
+                         << " with range [" << r.low << ", " << (r.low + 2 * (r.num_bits - 1)) << "]"
+                         << " | marks = " << r.marks
+                         << " | local prime count = " << r.primes << endl;
+
+                    // Print first few primes found in first segment
+                    int printed = 0;
+                    for (long long i = 0; r.seg_id == 0 && i < r.num_bits && printed < 10; i++) {
+                        if (state.segment.test(i)) {
+                            cout << "Thread " << tid
+                                 << " found surviving prime candidate: " << (r.low + 2 * i) << endl;
+                            printed++;
+                        }
                     }
-                    printed_mark_actions++;
                 }
             }
         }
+    };
 
-        // Count remaining primes in this segment
-        long long local_count = 0;
-        for (long long i = 0; i < odd_count; i++) {
-            if (segment[(size_t)i]) {
-                long long num = low + 2 * i;
-                if (num <= N) local_count++;
-
-                // Print first few primes found in first segment
-                if (VERBOSE && seg_id == 0 && local_count <= 10) {
-                    #pragma omp critical
-                    {
-                        cout << "Thread " << tid
-                             << " found surviving prime candidate: " << num << endl;
-                    }
-                }
-            }
-        }
-
-        if (VERBOSE) {
-            #pragma omp critical
-            {
-                cout << "Thread " << tid
-                     << " finished segment " << seg_id
-                     << " with local prime count = " << local_count << endl;
-            }
-        }
+    long long total_count = run_executor(ctx, options, trace, report);
 
-        total_count += local_count;
-    }
-
-    if (VERBOSE) {
-        cout << "OpenMP loop finished. Total prime count (including 2) = "
+    if constexpr (VERBOSE) {
+        cout << "Parallel loop finished. Total prime count (including 2) = "
              << total_count << endl;
     }
 
@@ -236,25 +120,73 @@ long long sieve_openmp(long long N, int num_threads) {
 }
 
 int main(int argc, char* argv[]) {
-    long long N = (argc > 1) ? atoll(argv[1]) : 100000000LL;
-    int threads = (argc > 2) ? atoi(argv[2])  : 4;
-
-    if (VERBOSE) {
+    SieveArgs args;
+    args.N = 100000000LL;
+    args.options.threads = 4;
+    args.options.executor = SieveExecutor::OpenMP;
+    if (!parse_sieve_args(argc, argv, true, args)) return 1;
+    if (args.options.threads < 1) args.options.threads = 1;
+
+    if constexpr (VERBOSE) {
         cout << "Program started." << endl;
-        cout << "Input N = " << N << ", threads = " << threads << endl;
+        cout << "Input N = " << args.N << ", threads = " << args.options.threads << endl;
     }
 
+    SieveTrace trace;
+    if (!args.trace_path.empty()) trace.enable(args.options.threads);
+
     auto t0 = high_resolution_clock::now();
-    long long count = sieve_openmp(N, threads);
+    SieveContext ctx;
+    long long count = 0;
+    PrimeStats stats;
+    JobResult job;
+    bool cache_hit = count_from_cache(args, count);
+    if (args.method == CountMethod::Lmo) {
+        count = args.range ? lmo_count_range(args.A, args.N, args.options, trace)
+                           : lmo_count(args.N, args.options, trace);
+        if (count < 0) return 1;
+    } else if (!cache_hit) {
+        build_context_from_args(args, ctx, trace);
+        if constexpr (VERBOSE) print_context(ctx, args.options);
+
+        // --print: segments are sieved in parallel but printed in order
+        if (!args.output_path.empty()) {
+            count = write_output_from_args(args, ctx, trace);
+        } else if (should_build_cache(args)) {
+            count = write_cache_from_args(args, ctx, trace);
+        } else if (args.stats) {
+            stats = prime_stats(ctx, args.options, trace);
+            count = stats.primes;
+        } else if (args.job_mode()) {
+            count = run_job_from_args(args, ctx, trace, job);
+        } else if (args.print_primes) {
+            count = stream_primes(ctx, args.options, trace, print_prime_block);
+        } else {
+            count = sieve_openmp(ctx, args.options, trace);
+        }
+        if (count < 0) return 1;
+    }
     auto t1 = high_resolution_clock::now();
 
     double elapsed = duration<double>(t1 - t0).count();
 
-    if (VERBOSE) {
+    if constexpr (VERBOSE) {
+        if (cache_hit) cout << "Answered from cache " << args.cache_path << endl;
         cout << "Execution finished in " << elapsed << " seconds." << endl;
     }
 
-    printf("N=%lld threads=%d count=%lld time_sec=%.6f\n", N, threads, count, elapsed);
+    if (!args.cache_path.empty()) trace.add_param("cache_hit", cache_hit ? 1 : 0);
+    finish_trace(trace, args, ctx, count, elapsed);
+
+    if (args.range) {
+        printf("A=%lld B=%lld threads=%d count=%lld time_sec=%.6f\n",
+               args.A, args.N, args.options.threads, count, elapsed);
+    } else {
+        printf("N=%lld threads=%d count=%lld time_sec=%.6f\n",
+               args.N, args.options.threads, count, elapsed);
+    }
+    if (args.stats) print_prime_stats(stats);
+    if (args.job_mode()) print_job_result(job);
 
-    return 0;
+    return (args.job_mode() && !job.complete()) ? 2 : 0;
 }
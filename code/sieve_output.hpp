@@ -0,0 +1,267 @@
+// ============================================================
+// sieve_output.hpp — Binary prime output through memory-mapped files
+// - Two payload formats:
+//   bitmap: the raw odd-only sieve, bit i = first_value + 2*i, packed
+//           in little-endian 64-bit words (N/16 bytes)
+//   gaps:   one byte per prime, (p - previous)/2, with 0 as an escape
+//           for a following 16-bit value. Each segment restarts from
+//           segment_low - 2 and an index gives its byte offset, so any
+//           segment can be decoded on its own
+// - Each worker copies/encodes its segment straight into the mapping at
+//   the segment's precomputed offset; no buffering, no locks
+//   (bitmap offsets follow from the geometry; gap offsets come from a
+//   first count-only pass that sizes every segment)
+// - A small header records the range, wheel and segment size, so a
+//   reader can mmap the file instead of re-sieving
+// File layout:
+//   [0, 4096)              SieveFileHeader
+//   index_offset           gaps only: (num_segments + 1) SieveFileIndexEntry
+//   payload_offset         payload (page aligned)
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+#include "sieve_mmap.hpp"
+
+static const char SIEVE_FILE_MAGIC[8] = {'S', 'I', 'E', 'V', 'E', 'B', 'I', 'N'};
+static const uint32_t SIEVE_FILE_VERSION = 1;
+static const uint64_t SIEVE_FILE_ALIGN = 4096;
+
+enum class SieveFileFormat : uint32_t { Bitmap = 1, Gaps = 2 };
+
+struct SieveFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;           // SieveFileFormat
+    uint64_t range_low;        // A (0 = the range starts at 2)
+    uint64_t N;                // upper end of the range (inclusive)
+    uint64_t first_value;      // odd number of bit 0 / of segment 0
+    uint64_t wheel;            // wheel modulus used while sieving
+    uint64_t segment_bytes;    // bitset bytes per segment (16 numbers per byte)
+    uint64_t num_segments;
+    uint64_t prime_count;      // primes in the range, including 2 if present
+    uint64_t index_offset;     // 0 when there is no index
+    uint64_t payload_offset;
+    uint64_t payload_bytes;
+};
+
+// Gaps format: where segment s starts in the payload and how many primes
+// (odd primes only) come before it. Entry num_segments closes the table.
+struct SieveFileIndexEntry {
+    uint64_t byte_offset;
+    uint64_t primes_before;
+};
+
+inline uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Parse "bitmap" / "gaps"
+inline bool parse_output_format(const std::string& name, SieveFileFormat& out) {
+    if (name == "bitmap") { out = SieveFileFormat::Bitmap; return true; }
+    if (name == "gaps")   { out = SieveFileFormat::Gaps; return true; }
+    return false;
+}
+
+// ------------------------------------------------------------
+// Gap encoding of one sieved segment
+// ------------------------------------------------------------
+
+// Encode the segment's primes as halved gaps into out, or only measure
+// them when out is null. Returns the number of bytes.
+inline size_t encode_segment_gaps(const SegmentBitset& segment, uint8_t* out) {
+    size_t bytes = 0;
+    long long prev = segment.low - 2;
+    segment.for_each_set([&](long long p) {
+        long long half_gap = (p - prev) / 2;
+        prev = p;
+        if (half_gap < 256) {
+            if (out) out[bytes] = (uint8_t)half_gap;
+            bytes += 1;
+        } else {
+            // Escape: 0 then 16-bit little endian (prime gaps stay far below 2^17)
+            if (out) {
+                out[bytes] = 0;
+                out[bytes + 1] = (uint8_t)(half_gap & 0xFF);
+                out[bytes + 2] = (uint8_t)(half_gap >> 8);
+            }
+            bytes += 3;
+        }
+    });
+    return bytes;
+}
+
+// ------------------------------------------------------------
+// Writer
+// ------------------------------------------------------------
+
+// Sieve ctx's range with the executor in options and write it to path.
+// Stores the prime count in count. Returns false if the file cannot be
+// created or mapped. The header is written last, so an interrupted run
+// never leaves a file that looks valid.
+inline bool write_sieve_file(const SieveContext& ctx, const SieveOptions& options, SieveTrace& trace,
+                             const std::string& path, SieveFileFormat format, long long& count) {
+    SieveFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SIEVE_FILE_MAGIC, sizeof(header.magic));
+    header.version = SIEVE_FILE_VERSION;
+    header.format = (uint32_t)format;
+    header.range_low = (uint64_t)ctx.A;
+    header.N = (uint64_t)ctx.N;
+    header.first_value = (uint64_t)ctx.first_value;
+    header.wheel = (uint64_t)ctx.wheel.modulus;
+    header.segment_bytes = (uint64_t)ctx.segment_bytes;
+    header.num_segments = (uint64_t)ctx.num_segments;
+
+    MappedFile file;
+
+    if (format == SieveFileFormat::Bitmap) {
+        long long total_bits = ctx.num_segments > 0 ? (ctx.N - ctx.first_value) / 2 + 1 : 0;
+        header.payload_offset = SIEVE_FILE_ALIGN;
+        header.payload_bytes = (uint64_t)((total_bits + 63) / 64) * 8;
+        if (!file.create(path, (size_t)(header.payload_offset + header.payload_bytes))) return false;
+
+        // Full segments are a whole number of words, so segment s starts
+        // at byte s * segment_bytes of the payload
+        uint8_t* payload = file.data() + header.payload_offset;
+        auto copy_segment = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+            std::memcpy(payload + r.seg_id * ctx.segment_bytes, state.segment.words.data(),
+                        state.segment.word_count() * sizeof(uint64_t));
+        };
+        count = run_executor(ctx, options, trace, copy_segment);
+    } else {
+        // Pass 1: size every segment's encoding (no output yet)
+        double phase_t0 = trace_now();
+        std::vector<SieveFileIndexEntry> index((size_t)ctx.num_segments + 1);
+        std::vector<uint64_t> seg_bytes((size_t)ctx.num_segments, 0);
+        std::vector<uint64_t> seg_primes((size_t)ctx.num_segments, 0);
+        auto size_segment = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+            seg_bytes[(size_t)r.seg_id] = encode_segment_gaps(state.segment, nullptr);
+            seg_primes[(size_t)r.seg_id] = (uint64_t)r.primes;
+        };
+        run_executor(ctx, options, trace, size_segment);
+
+        uint64_t offset = 0;
+        uint64_t primes_before = 0;
+        for (size_t s = 0; s < seg_bytes.size(); s++) {
+            index[s].byte_offset = offset;
+            index[s].primes_before = primes_before;
+            offset += seg_bytes[s];
+            primes_before += seg_primes[s];
+        }
+        index.back().byte_offset = offset;
+        index.back().primes_before = primes_before;
+        trace.add_phase("output_size_pass_sec", trace_now() - phase_t0);
+
+        header.index_offset = SIEVE_FILE_ALIGN;
+        header.payload_offset =
+            align_up(header.index_offset + index.size() * sizeof(SieveFileIndexEntry), SIEVE_FILE_ALIGN);
+        header.payload_bytes = offset;
+        if (!file.create(path, (size_t)(header.payload_offset + header.payload_bytes))) return false;
+
+        std::memcpy(file.data() + header.index_offset, index.data(),
+                    index.size() * sizeof(SieveFileIndexEntry));
+
+        // Pass 2: every worker encodes straight into its segment's slot
+        uint8_t* payload = file.data() + header.payload_offset;
+        auto encode_segment = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+            encode_segment_gaps(state.segment, payload + index[(size_t)r.seg_id].byte_offset);
+        };
+        count = run_executor(ctx, options, trace, encode_segment);
+    }
+
+    header.prime_count = (uint64_t)count;
+    std::memcpy(file.data(), &header, sizeof(header));
+    return true;
+}
+
+// ------------------------------------------------------------
+// Reader
+// ------------------------------------------------------------
+class SieveFileReader {
+public:
+    // Map path and check its header. Returns false if it is not a valid sieve file.
+    bool open(const std::string& path) {
+        if (!file_.open_read(path) || file_.size() < sizeof(SieveFileHeader)) return false;
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, SIEVE_FILE_MAGIC, sizeof(header_.magic)) != 0) return false;
+        if (header_.version != SIEVE_FILE_VERSION) return false;
+        if (header_.payload_offset + header_.payload_bytes > file_.size()) return false;
+        if (header_.format == (uint32_t)SieveFileFormat::Gaps &&
+            header_.index_offset + (header_.num_segments + 1) * sizeof(SieveFileIndexEntry) >
+                header_.payload_offset) {
+            return false;
+        }
+        return true;
+    }
+
+    const SieveFileHeader& header() const { return header_; }
+
+    bool has_even_prime() const { return header_.range_low <= 2 && header_.N >= 2; }
+
+    // Bitmap files only: is x (inside the stored range) prime?
+    bool is_prime(long long x) const {
+        if (x == 2) return has_even_prime();
+        if (x % 2 == 0 || x < (long long)header_.first_value || x > (long long)header_.N) return false;
+        const uint64_t* words = payload_words();
+        long long i = (x - (long long)header_.first_value) / 2;
+        return (words[(size_t)(i >> 6)] >> (i & 63)) & 1ULL;
+    }
+
+    // Call f(p) for every stored prime, in increasing order
+    template <typename F>
+    void for_each_prime(F&& f) const {
+        if (has_even_prime()) f(2LL);
+        const uint8_t* payload = file_.data() + header_.payload_offset;
+        long long first_value = (long long)header_.first_value;
+
+        if (header_.format == (uint32_t)SieveFileFormat::Bitmap) {
+            const uint64_t* words = payload_words();
+            size_t num_words = (size_t)(header_.payload_bytes / sizeof(uint64_t));
+            for (size_t w = 0; w < num_words; w++) {
+                uint64_t bits = words[w];
+                while (bits != 0) {
+                    f(first_value + 2 * ((long long)(w * 64) + __builtin_ctzll(bits)));
+                    bits &= bits - 1;
+                }
+            }
+            return;
+        }
+
+        const SieveFileIndexEntry* index = index_entries();
+        long long seg_size = (long long)header_.segment_bytes * 16;
+        for (uint64_t s = 0; s < header_.num_segments; s++) {
+            long long prev = first_value + (long long)s * seg_size - 2;
+            const uint8_t* p = payload + index[s].byte_offset;
+            const uint8_t* end = payload + index[s + 1].byte_offset;
+            while (p < end) {
+                long long half_gap = *p++;
+                if (half_gap == 0) {
+                    half_gap = (long long)p[0] | ((long long)p[1] << 8);
+                    p += 2;
+                }
+                prev += 2 * half_gap;
+                f(prev);
+            }
+        }
+    }
+
+private:
+    const uint64_t* payload_words() const {
+        return reinterpret_cast<const uint64_t*>(file_.data() + header_.payload_offset);
+    }
+
+    const SieveFileIndexEntry* index_entries() const {
+        return reinterpret_cast<const SieveFileIndexEntry*>(file_.data() + header_.index_offset);
+    }
+
+    MappedFile file_;
+    SieveFileHeader header_;
+};
@@ -0,0 +1,114 @@
+// ============================================================
+// sieve_perf.hpp — Hardware counters through Linux perf_event
+// Used by sieve_bench.cpp
+// - Counts cycles, instructions and last-level-cache misses of this
+//   process, including threads created after start() (inherit=1), in
+//   user space only (works with perf_event_paranoid <= 2)
+// - Each counter is opened on its own: inherited counters cannot be read
+//   as a group
+// - Where perf_event is missing (non-Linux, containers without the
+//   syscall, paranoid = 3) the counters simply report as unavailable
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SIEVE_HAVE_PERF_EVENT 1
+#else
+#define SIEVE_HAVE_PERF_EVENT 0
+#endif
+
+struct PerfSample {
+    bool valid = false;
+    long long cycles = 0;
+    long long instructions = 0;
+    long long llc_misses = 0;
+
+    double ipc() const { return cycles > 0 ? (double)instructions / (double)cycles : 0.0; }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Open the counters. Returns false if the kernel refuses any of them.
+    bool open() {
+        close();
+#if SIEVE_HAVE_PERF_EVENT
+        static const uint64_t CONFIGS[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = CONFIGS[i];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds_[i] < 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool is_open() const { return fds_[0] >= 0; }
+
+    void start() {
+#if SIEVE_HAVE_PERF_EVENT
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Stop counting and return what was counted since start()
+    PerfSample stop() {
+        PerfSample s;
+#if SIEVE_HAVE_PERF_EVENT
+        if (!is_open()) return s;
+        long long values[NUM_COUNTERS] = {0, 0, 0};
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds_[i], &values[i], sizeof(values[i])) != (ssize_t)sizeof(values[i])) return s;
+        }
+        s.valid = true;
+        s.cycles = values[0];
+        s.instructions = values[1];
+        s.llc_misses = values[2];
+#endif
+        return s;
+    }
+
+    void close() {
+#if SIEVE_HAVE_PERF_EVENT
+        for (int& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+private:
+    static const int NUM_COUNTERS = 3;
+    int fds_[NUM_COUNTERS] = {-1, -1, -1};
+};
@@ -0,0 +1,241 @@
+// ============================================================
+// sieve_pipeline.hpp — Pipelined executor: sieving overlapped with consumers
+// - Sieve workers (std::thread, runs pulled from an atomic counter as in
+//   the thread pool) sieve into their own segment buffer, then swap it
+//   with a free buffer from a fixed pool: the finished bitmap moves on
+//   without a copy and the worker keeps sieving into the recycled one
+// - Finished buffers travel through lock-free single-producer /
+//   single-consumer rings: worker -> stage 0 -> stage 1 -> ... and the
+//   last stage hands each buffer back to the worker that owns it
+// - Stage 0 takes the segments from the workers' rings in increasing
+//   order, so every stage sees every segment in order, one at a time,
+//   on its own thread, while the workers already sieve the next ones
+// - Backpressure: each worker owns a few buffers. A worker with none
+//   free waits until the last stage returns one, so memory is fixed and
+//   a slow consumer slows the sieve down instead of piling up bitmaps.
+// Threads: num_workers sieve workers plus one thread per stage.
+// No deadlock: the oldest missing segment belongs to a worker whose
+// earlier segments were all consumed, so its buffers always come back.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sieve_engine.hpp"
+
+// Buffers per sieve worker: one being sieved, the rest queued downstream
+static const int PIPELINE_BUFFERS_PER_WORKER = 4;
+
+// ------------------------------------------------------------
+// Bounded lock-free ring, one producer thread and one consumer thread
+// ------------------------------------------------------------
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two. Call before any thread uses it.
+    void init(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        slots_.assign(capacity, T());
+        mask_ = capacity - 1;
+    }
+
+    // Producer side. Returns false if the ring is full.
+    bool push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_seen_ == slots_.size()) {
+            head_seen_ = head_.load(std::memory_order_acquire);
+            if (tail - head_seen_ == slots_.size()) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: look at the oldest entry without removing it.
+    // Returns false if the ring is empty.
+    bool peek(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_seen_) {
+            tail_seen_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_seen_) return false;
+        }
+        value = slots_[head & mask_];
+        return true;
+    }
+
+    // Consumer side: drop the entry returned by peek()
+    void pop() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool try_pop(T& value) {
+        if (!peek(value)) return false;
+        pop();
+        return true;
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    // Each side's index and its cached copy of the other side's index share
+    // a line, so the two threads only exchange lines when the cache is stale
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> head_{0};   // consumer
+    size_t tail_seen_ = 0;
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> tail_{0};   // producer
+    size_t head_seen_ = 0;
+};
+
+// One pooled segment: the bitmap and what the kernel reported about it
+struct alignas(CACHE_LINE_BYTES) PipelineBuffer {
+    SegmentBitset segment;
+    SegmentResult result;
+    int owner = 0;   // worker whose free ring it returns to
+};
+
+// A consumer stage, called once per segment in increasing order on the
+// stage's own thread. The stage holds the buffer for the call and may
+// change it in place; later stages see the change.
+typedef std::function<void(SegmentBitset&, const SegmentResult&)> PipelineStage;
+
+// Nothing to do yet: give the core to another thread of the pipeline
+inline void pipeline_wait() { std::this_thread::yield(); }
+
+// ------------------------------------------------------------
+// The pipeline
+// ------------------------------------------------------------
+
+// Sieve ctx's segments on num_workers workers and run every segment
+// through stages, in order. Returns the prime count.
+inline long long run_pipeline(const SieveContext& ctx, int num_workers, SieveTrace& trace,
+                              const std::vector<PipelineStage>& stages,
+                              long long max_run = MAX_RUN_SEGMENTS,
+                              int buffers_per_worker = PIPELINE_BUFFERS_PER_WORKER) {
+    long long total = ctx.even_prime_count();
+    if (ctx.num_segments == 0) return total;
+    if (num_workers < 1) num_workers = 1;
+    if (buffers_per_worker < 1) buffers_per_worker = 1;
+
+    long long run_length = plan_run_length(ctx, num_workers, max_run);
+    long long num_runs = (ctx.num_segments + run_length - 1) / run_length;
+    size_t workers = (size_t)num_workers;
+    size_t per_worker = (size_t)buffers_per_worker;
+    size_t num_stages = std::max<size_t>(1, stages.size());   // stage 0 also orders
+
+    // Rings: free buffers (last stage -> worker), sieved buffers
+    // (worker -> stage 0), and one link per pair of consecutive stages
+    std::vector<PipelineBuffer> pool(workers * per_worker);
+    std::vector<SpscRing<PipelineBuffer*>> free_rings(workers), done_rings(workers);
+    std::vector<SpscRing<PipelineBuffer*>> links(num_stages - 1);
+    for (size_t w = 0; w < workers; w++) {
+        free_rings[w].init(per_worker);
+        done_rings[w].init(per_worker);
+        for (size_t b = 0; b < per_worker; b++) {
+            PipelineBuffer& buf = pool[w * per_worker + b];
+            buf.owner = (int)w;
+            free_rings[w].push(&buf);
+        }
+    }
+    for (SpscRing<PipelineBuffer*>& link : links) link.init(pool.size());
+
+    std::atomic<long long> next_run(0);
+    std::vector<long long> counts(workers, 0);
+
+    auto worker = [&](int tid) {
+        ThreadTrace* tt = trace.thread(tid);
+        double region_t0 = tt ? trace_now() : 0.0;
+
+        // The worker's state and its pool buffers are first touched here
+        SieveThreadState state;
+        state.init(ctx.wheel, ctx.seg_bits);
+        for (size_t b = 0; b < per_worker; b++) pool[(size_t)tid * per_worker + b].segment.reserve_bits(ctx.seg_bits);
+
+        SpscRing<PipelineBuffer*>& free_ring = free_rings[(size_t)tid];
+        SpscRing<PipelineBuffer*>& done_ring = done_rings[(size_t)tid];
+        long long local = 0;
+        for (;;) {
+            long long run_id = next_run.fetch_add(1, std::memory_order_relaxed);
+            if (run_id >= num_runs) break;
+            long long run_begin = run_id * run_length;
+            long long run_end = std::min(run_begin + run_length, ctx.num_segments);
+            begin_run(state, ctx, run_begin, run_end);
+            if (tt) tt->runs++;
+
+            for (long long s = run_begin; s < run_end; s++) {
+                double seg_t0 = tt ? trace_now() : 0.0;
+                SegmentResult r = sieve_segment(state, ctx, s);
+                if (tt) tt->record_segment(trace_now() - seg_t0, r.marks, r.primes);
+                local += r.primes;
+
+                // Hand the bitmap on by swapping buffers (no copy of the bits);
+                // the swapped-in buffer is overwritten by the next segment
+                PipelineBuffer* buf = nullptr;
+                while (!free_ring.try_pop(buf)) pipeline_wait();
+                std::swap(state.segment, buf->segment);
+                buf->result = r;
+                while (!done_ring.push(buf)) pipeline_wait();
+            }
+        }
+        counts[(size_t)tid] = local;
+
+        if (tt) tt->region_sec = trace_now() - region_t0;
+    };
+
+    auto stage_thread = [&](size_t i) {
+        size_t last = 0;   // consecutive segments usually come from the same worker
+        for (long long s = 0; s < ctx.num_segments; s++) {
+            PipelineBuffer* buf = nullptr;
+            if (i == 0) {
+                // Once sieved, segment s is at the front of exactly one worker's ring
+                bool found = false;
+                while (!found) {
+                    for (size_t k = 0; k < workers && !found; k++) {
+                        size_t w = (last + k) % workers;
+                        if (done_rings[w].peek(buf) && buf->result.seg_id == s) {
+                            done_rings[w].pop();
+                            last = w;
+                            found = true;
+                        }
+                    }
+                    if (!found) pipeline_wait();
+                }
+            } else {
+                while (!links[i - 1].try_pop(buf)) pipeline_wait();
+            }
+
+            if (i < stages.size()) stages[i](buf->segment, buf->result);
+
+            SpscRing<PipelineBuffer*>& next = i + 1 < num_stages ? links[i] : free_rings[(size_t)buf->owner];
+            while (!next.push(buf)) pipeline_wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_stages; i++) threads.emplace_back(stage_thread, i);
+    for (int t = 1; t < num_workers; t++) threads.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& th : threads) th.join();
+
+    for (long long c : counts) total += c;
+    return total;
+}
+
+// Executor form (SieveExecutor::Pipeline): visit(0, state, result) is the
+// single stage, so visitors run in segment order, never concurrently.
+// state.segment is the finished bitmap, moved in for the call.
+template <typename Visitor>
+long long run_pipelined(const SieveContext& ctx, int num_workers, SieveTrace& trace,
+                        Visitor& visit, long long max_run = MAX_RUN_SEGMENTS) {
+    SieveThreadState view;   // only its segment is used
+    std::vector<PipelineStage> stages(1, [&](SegmentBitset& segment, const SegmentResult& r) {
+        std::swap(view.segment, segment);
+        visit(0, view, r);
+        std::swap(view.segment, segment);
+    });
+    return run_pipeline(ctx, num_workers, trace, stages, max_run);
+}
@@ -0,0 +1,144 @@
+// ============================================================
+// sieve_primality.cpp — Batch primality service above the sieve ceiling
+// C++ version of the notebook's Miller–Rabin check
+// (is_probable_prime_miller_rabin / compare_sieve_check_vs_miller_rabin)
+// - Prefilters the candidate window with a segmented small-prime sieve,
+//   then tests the survivors with Montgomery Miller–Rabin
+//   (see sieve_primality.hpp and sieve_miller_rabin.hpp)
+// - Works for any window inside [0, 2^128): deterministic below
+//   3.3 * 10^24, probable primes above
+// Usage: ./sieve_primality <A> <B> [threads] [--prefilter <limit>]
+//                         [--executor openmp|pool|numa|steal|pipeline|serial]
+//                         [--segment-bytes <B>] [--wheel <modulus>] [--print]
+// A and B may be written as sums of terms like 2^127+1000 or 10^20-1
+// --print writes every prime in order (one thread)
+// Output: A=<A> B=<B> threads=<T> candidates=<count> tested=<count> count=<primes>
+//         time_sec=<time> candidates_per_sec=<rate>
+// ============================================================
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "sieve_primality.hpp"
+#include "sieve_cli.hpp"
+
+using namespace std;
+using namespace chrono;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+struct PrimalityArgs {
+    uint128_t A = 0;
+    uint128_t B = 0;
+    PrimalityOptions options;
+    bool print_primes = false;
+};
+
+// ------------------------------------------------------------
+// Step 1: Parse the window and options
+// ------------------------------------------------------------
+bool parse_primality_args(int argc, char* argv[], PrimalityArgs& args) {
+    vector<string> positional;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--print") {
+            args.print_primes = true;
+        } else if (arg == "--prefilter" && has_value) {
+            args.options.prefilter_limit = atoll(argv[++i]);
+        } else if (arg == "--segment-bytes" && has_value) {
+            args.options.sieve.segment_bytes = atoll(argv[++i]);
+        } else if (arg == "--wheel" && has_value) {
+            args.options.sieve.wheel_modulus = atoll(argv[++i]);
+        } else if (arg == "--executor" && has_value) {
+            if (!parse_executor_name(argv[++i], args.options.sieve.executor)) {
+                fprintf(stderr, "Unknown executor %s (use serial, openmp, pool, numa, steal or pipeline)\n", argv[i]);
+                return false;
+            }
+        } else if (arg.rfind("--", 0) == 0) {
+            fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() < 2 || positional.size() > 3) {
+        fprintf(stderr, "Usage: %s <A> <B> [threads] [--prefilter <limit>] [--print]\n", argv[0]);
+        return false;
+    }
+    if (!parse_u128(positional[0], args.A) || !parse_u128(positional[1], args.B)) {
+        fprintf(stderr, "A and B must be integers below 2^128 (e.g. 2^127+1000)\n");
+        return false;
+    }
+    if (args.A > args.B) {
+        fprintf(stderr, "Bad window [%s, %s] (need A <= B)\n",
+                u128_to_string(args.A).c_str(), u128_to_string(args.B).c_str());
+        return false;
+    }
+    if (positional.size() == 3) args.options.sieve.threads = atoi(positional[2].c_str());
+    if (args.options.sieve.threads < 1) args.options.sieve.threads = 1;
+    if (args.options.prefilter_limit < 2) args.options.prefilter_limit = 2;
+
+    WheelPattern wheel_check;
+    if (!wheel_check.build(args.options.sieve.wheel_modulus)) {
+        fprintf(stderr, "Unsupported wheel modulus %lld (use 2, 6, 30, 210, 2310, 30030 or 510510)\n",
+                args.options.sieve.wheel_modulus);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    PrimalityArgs args;
+    args.options.sieve.threads = 1;
+#ifdef _OPENMP
+    args.options.sieve.executor = SieveExecutor::OpenMP;
+#else
+    args.options.sieve.executor = SieveExecutor::ThreadPool;
+#endif
+    if (!parse_primality_args(argc, argv, args)) return 1;
+
+    // --print: one worker, so the primes come out in increasing order
+    if (args.print_primes) {
+        args.options.sieve.threads = 1;
+        args.options.sieve.executor = SieveExecutor::Serial;
+    }
+
+    if constexpr (VERBOSE) {
+        cout << "Window [" << u128_to_string(args.A) << ", " << u128_to_string(args.B) << "]" << endl;
+        cout << "Prefilter primes up to " << args.options.prefilter_limit
+             << ", threads = " << args.options.sieve.threads << endl;
+    }
+
+    SieveTrace trace;
+    auto t0 = high_resolution_clock::now();
+    PrimalityStats stats;
+    if (args.print_primes) {
+        stats = batch_primes(args.A, args.B, args.options, trace,
+                             [](uint128_t p) { printf("%s\n", u128_to_string(p).c_str()); });
+    } else {
+        stats = batch_primes(args.A, args.B, args.options, trace, [](uint128_t) {});
+    }
+    auto t1 = high_resolution_clock::now();
+
+    double elapsed = duration<double>(t1 - t0).count();
+    double rate = elapsed > 0 ? (double)stats.candidates / elapsed : 0.0;
+
+    if constexpr (VERBOSE) {
+        double survive = stats.candidates > 0 ? 100.0 * stats.tested / (double)stats.candidates : 0.0;
+        cout << "Prefilter survivors = " << stats.tested << " (" << survive << " % of the window)" << endl;
+        cout << "Miller-Rabin tests per second = " << (elapsed > 0 ? stats.tested / elapsed : 0.0) << endl;
+    }
+
+    printf("A=%s B=%s threads=%d candidates=%s tested=%lld count=%lld time_sec=%.6f candidates_per_sec=%.0f\n",
+           u128_to_string(args.A).c_str(), u128_to_string(args.B).c_str(), args.options.sieve.threads,
+           u128_to_string(stats.candidates).c_str(), stats.tested, stats.primes, elapsed, rate);
+
+    return 0;
+}
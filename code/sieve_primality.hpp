@@ -0,0 +1,279 @@
+// ============================================================
+// sieve_primality.hpp — Batch primality: sieve prefilter + Miller–Rabin
+// Used by sieve_primality.cpp
+// For candidate windows [A, B] above the sieve ceiling (no base primes up
+// to sqrt(B)), e.g. key-generation style searches at 2^64 .. 2^128:
+// - Prefilter: the window is sieved by the small primes up to
+//   prefilter_limit only. Windows below 2^63 use the shared engine
+//   unchanged (range context with a shortened base prime list, so the
+//   wheel, pre-sieve, offsets and buckets all apply); wider values use a
+//   segmented 128-bit loop with the same odd-only bitsets
+// - Survivors (no factor <= prefilter_limit) go to Miller–Rabin:
+//   deterministic for 64-bit values, 128-bit variant above
+//   (sieve_miller_rabin.hpp)
+// - Segments are spread over threads: an executor of the engine for the
+//   64-bit path, OpenMP (or std::thread without it) for the 128-bit path;
+//   each worker tests its own segment's survivors
+// If prefilter_limit^2 > B the prefilter alone is already exact; the
+// survivors still go through Miller–Rabin, which then only confirms them.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+#include "sieve_miller_rabin.hpp"
+
+// Default prefilter: primes below 2^16 (see README for the trade-off)
+static const long long DEFAULT_PREFILTER_LIMIT = 65536;
+
+// Largest B handled by the engine (its segment arithmetic is in long long)
+static const uint128_t ENGINE_MAX_VALUE = (uint128_t)INT64_MAX;
+
+struct PrimalityOptions {
+    long long prefilter_limit = DEFAULT_PREFILTER_LIMIT;
+    SieveOptions sieve;   // executor, threads, segment size, wheel of the prefilter
+};
+
+struct PrimalityStats {
+    uint128_t candidates = 0;   // numbers in [A, B]
+    long long tested = 0;       // prefilter survivors sent to Miller–Rabin
+    long long primes = 0;       // primes found (count)
+};
+
+// One worker's counters, padded so threads never share a line
+struct alignas(CACHE_LINE_BYTES) PrimalityWorkerCounts {
+    long long tested = 0;
+    long long primes = 0;
+};
+
+// Test every survivor of a sieved segment; on_prime(p) for each prime
+template <typename F>
+void test_survivors(const SegmentBitset& seg, uint128_t low, PrimalityWorkerCounts& counts, F& on_prime) {
+    size_t n = seg.word_count();
+    for (size_t w = 0; w < n; w++) {
+        uint64_t bits = seg.words[w];
+        while (bits != 0) {
+            uint128_t value = low + 2 * (uint128_t)(w * 64 + __builtin_ctzll(bits));
+            counts.tested++;
+            if (is_prime_u128(value)) {
+                counts.primes++;
+                on_prime(value);
+            }
+            bits &= bits - 1;
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// 64-bit windows: the shared engine with a short base prime list
+// ------------------------------------------------------------
+template <typename F>
+PrimalityStats batch_primes_engine(long long A, long long B, const PrimalityOptions& options,
+                                   SieveTrace& trace, F& on_prime) {
+    PrimalityStats stats;
+    SieveContext ctx;
+    prepare_range_context(A, B, options.sieve, ctx);
+
+    double phase_t0 = trace_now();
+    long long limit = std::min(options.prefilter_limit, integer_sqrt(B));
+    set_base_primes(ctx, generate_base_primes(std::max(limit, 2LL), options.sieve.threads));
+    trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+
+    int workers = std::max(1, options.sieve.threads);
+    std::vector<PrimalityWorkerCounts> counts((size_t)workers);
+    auto visit = [&](int tid, const SieveThreadState& state, const SegmentResult& r) {
+        test_survivors(state.segment, (uint128_t)r.low, counts[(size_t)tid], on_prime);
+    };
+
+    if (ctx.even_prime_count() > 0) {
+        stats.primes++;
+        on_prime((uint128_t)2);
+    }
+    run_executor(ctx, options.sieve, trace, visit);
+
+    for (const PrimalityWorkerCounts& c : counts) {
+        stats.tested += c.tested;
+        stats.primes += c.primes;
+    }
+    return stats;
+}
+
+// ------------------------------------------------------------
+// 128-bit windows: segmented prefilter with 128-bit residues
+// ------------------------------------------------------------
+
+template <typename F>
+PrimalityStats batch_primes_wide(uint128_t A, uint128_t B, const PrimalityOptions& options,
+                                 SieveTrace& trace, F& on_prime) {
+    PrimalityStats stats;
+    uint128_t first = A | 1;   // A > 2^63 here, so 2 is never in range
+    if (first > B) return stats;
+
+    double phase_t0 = trace_now();
+    std::vector<uint32_t> primes = generate_base_primes(std::max(options.prefilter_limit, 2LL),
+                                                        options.sieve.threads);
+    trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+
+    long long seg_bits = (options.sieve.segment_bytes > 0
+                              ? normalize_segment_bytes(options.sieve.segment_bytes)
+                              : default_segment_bytes(detect_cache_info())) * 8;
+    uint128_t total_bits = (B - first) / 2 + 1;
+    uint128_t num_segments_wide = (total_bits + seg_bits - 1) / seg_bits;
+    if (num_segments_wide > (uint128_t)INT64_MAX) {
+        fprintf(stderr, "Window too wide for the 128-bit prefilter\n");
+        return stats;
+    }
+    long long num_segments = (long long)num_segments_wide;
+
+    // Runs of segments share one 128-bit division per prime, as in the engine
+    int workers = std::max(1, options.sieve.threads);
+    long long run_length = std::min(MAX_RUN_SEGMENTS, std::max(1LL, num_segments / (8LL * workers)));
+    long long num_runs = (num_segments + run_length - 1) / run_length;
+
+    std::vector<PrimalityWorkerCounts> counts((size_t)workers);
+    parallel_items(num_runs, workers, [&](int tid, long long run_id) {
+        long long run_begin = run_id * run_length;
+        long long run_end = std::min(run_begin + run_length, num_segments);
+        uint128_t run_low = first + 2 * (uint128_t)seg_bits * (uint128_t)run_begin;
+
+        // Bit index of the next odd multiple of each odd prime, carried across segments
+        std::vector<long long> next(primes.size(), 0);
+        for (size_t i = 1; i < primes.size(); i++) {
+            long long p = primes[i];
+            long long offset = (long long)((p - (uint64_t)(run_low % (uint64_t)p)) % p);
+            if (offset % 2 != 0) offset += p;
+            next[i] = offset / 2;
+        }
+
+        SegmentBitset seg;
+        for (long long s = run_begin; s < run_end; s++) {
+            uint128_t low = first + 2 * (uint128_t)seg_bits * (uint128_t)s;
+            uint128_t left = (B - low) / 2 + 1;
+            long long num_bits = left < (uint128_t)seg_bits ? (long long)left : seg_bits;
+            seg.reset(0, num_bits);
+
+            for (size_t i = 1; i < primes.size(); i++) {
+                long long p = primes[i];
+                long long idx = next[i];
+                for (; idx < num_bits; idx += p) seg.clear(idx);
+                next[i] = idx - num_bits;
+            }
+            test_survivors(seg, low, counts[(size_t)tid], on_prime);
+        }
+    });
+
+    for (const PrimalityWorkerCounts& c : counts) {
+        stats.tested += c.tested;
+        stats.primes += c.primes;
+    }
+    return stats;
+}
+
+// Count (and report through on_prime) the primes in [A, B]. on_prime runs on
+// the worker threads; with one thread (serial executor) it sees them in order.
+template <typename F>
+PrimalityStats batch_primes(uint128_t A, uint128_t B, const PrimalityOptions& options,
+                            SieveTrace& trace, F&& on_prime) {
+    PrimalityStats stats;
+    if (A > B) return stats;
+    if (B <= ENGINE_MAX_VALUE) {
+        stats = batch_primes_engine((long long)A, (long long)B, options, trace, on_prime);
+    } else if (A <= ENGINE_MAX_VALUE) {
+        // Straddles 2^63: the part below goes through the engine
+        stats = batch_primes_engine((long long)A, INT64_MAX, options, trace, on_prime);
+        PrimalityStats upper = batch_primes_wide(ENGINE_MAX_VALUE + 1, B, options, trace, on_prime);
+        stats.tested += upper.tested;
+        stats.primes += upper.primes;
+    } else {
+        stats = batch_primes_wide(A, B, options, trace, on_prime);
+    }
+    stats.candidates = B - A + 1;
+    return stats;
+}
+
+// ------------------------------------------------------------
+// 128-bit values as text
+// ------------------------------------------------------------
+inline std::string u128_to_string(uint128_t v) {
+    if (v == 0) return "0";
+    std::string s;
+    while (v > 0) {
+        s.push_back((char)('0' + (int)(v % 10)));
+        v /= 10;
+    }
+    std::reverse(s.begin(), s.end());
+    return s;
+}
+
+// One term: decimal digits, or b^e (e.g. 2^127, 10^18). Values up to 2^128
+// are accepted, so that 2^128-1 can be written; top is set for 2^128 itself.
+inline bool parse_u128_term(const std::string& text, uint128_t& out, bool& top) {
+    top = false;
+    size_t caret = text.find('^');
+    std::string digits = caret == std::string::npos ? text : text.substr(0, caret);
+    if (digits.empty()) return false;
+    uint128_t value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        uint128_t hi, lo;
+        mul_wide_128(value, 10, hi, lo);
+        uint128_t next = lo + (uint128_t)(c - '0');
+        if (hi != 0 || next < lo) return false;   // past 2^128 - 1
+        value = next;
+    }
+    if (caret != std::string::npos) {
+        uint128_t base = value, exp = 0;
+        bool exp_top = false;
+        if (!parse_u128_term(text.substr(caret + 1), exp, exp_top) || exp_top) return false;
+        value = 1;
+        for (uint128_t i = 0; i < exp && base > 1; i++) {
+            uint128_t hi, lo;
+            mul_wide_128(value, base, hi, lo);
+            if (hi == 1 && lo == 0 && i + 1 == exp) {
+                top = true;   // exactly 2^128
+                value = 0;
+                break;
+            }
+            if (hi != 0) return false;
+            value = lo;
+        }
+        if (base == 0) value = exp == 0 ? 1 : 0;
+    }
+    out = value;
+    return true;
+}
+
+// A sum / difference of terms, e.g. "2^127+1000" or "2^128-1". The running
+// total may pass 2^128 on the way, as long as the result is below it.
+inline bool parse_u128(const std::string& text, uint128_t& out) {
+    uint128_t total = 0;
+    long long high = 0;   // multiples of 2^128 carried by the running total
+    bool negative = false;
+    size_t start = 0;
+    for (size_t i = 0; i <= text.size(); i++) {
+        if (i < text.size() && text[i] != '+' && text[i] != '-') continue;
+        uint128_t term = 0;
+        bool top = false;
+        if (!parse_u128_term(text.substr(start, i - start), term, top)) return false;
+        if (negative) {
+            high -= (top ? 1 : 0) + (term > total ? 1 : 0);
+            total -= term;
+        } else {
+            high += (top ? 1 : 0) + (total + term < total ? 1 : 0);
+            total += term;
+        }
+        if (high < -1 || high > 1) return false;
+        if (i < text.size()) negative = text[i] == '-';
+        start = i + 1;
+    }
+    if (high != 0) return false;
+    out = total;
+    return true;
+}
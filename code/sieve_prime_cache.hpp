@@ -0,0 +1,231 @@
+// ============================================================
+// sieve_prime_cache.hpp — Persistent prime cache with pi(x) / is_prime(x)
+// - Stores the primes <= limit as a mod-30 wheel bitmap: byte k holds
+//   the 8 numbers 30k + {1, 7, 11, 13, 17, 19, 23, 29}, the only
+//   residues that can be prime (besides 2, 3, 5). 30 numbers per byte,
+//   about 2x denser than the odd-only sieve
+// - Every 64 KiB block of bitmap has a cumulative prime count, so
+//   pi(x) = index[block] + popcount over part of one block, and
+//   is_prime(x) is a single bit lookup
+// - Built once from the shared engine (any executor); the file is then
+//   mmap'd read-only by every later query (see sieve_mmap.hpp)
+// - open(path, policy) with a huge page policy copies the index and
+//   bitmap into anonymous memory on huge pages instead
+//   (sieve_hugepages.hpp): one up-front read of the file, then random
+//   lookups into a multi-GiB cache stop missing the TLB on every query
+// File layout:
+//   [0, 4096)        PrimeCacheHeader
+//   index_offset     (num_blocks + 1) uint64 counts of bitmap primes before each block
+//   bitmap_offset    bitmap (page aligned), limit/30 + 1 bytes
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+#include "sieve_hugepages.hpp"
+#include "sieve_mmap.hpp"
+#include "sieve_output.hpp"
+
+static const char PRIME_CACHE_MAGIC[8] = {'S', 'I', 'E', 'V', 'E', 'C', '3', '0'};
+static const uint32_t PRIME_CACHE_VERSION = 1;
+static const uint64_t PRIME_CACHE_BLOCK_BYTES = 64 * 1024;  // 1,966,080 numbers per block
+
+// Bit of residue r (mod 30) within its byte; 0 for residues that share a factor with 30
+static const uint8_t WHEEL30_BIT[30] = {
+    0, 1 << 0, 0, 0, 0, 0, 0, 1 << 1, 0, 0, 0, 1 << 2, 0, 1 << 3, 0,
+    0, 0, 1 << 4, 0, 1 << 5, 0, 0, 0, 1 << 6, 0, 0, 0, 0, 0, 1 << 7};
+
+// Bits of every residue <= r (mod 30): the part of a byte that counts toward pi(30k + r)
+static const uint8_t WHEEL30_UPTO[30] = {
+    0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03,
+    0x03, 0x07, 0x07, 0x0F, 0x0F, 0x0F, 0x0F, 0x1F, 0x1F, 0x3F,
+    0x3F, 0x3F, 0x3F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0xFF};
+
+struct PrimeCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t limit;            // every prime <= limit is in the cache
+    uint64_t block_bytes;      // bitmap bytes per index block
+    uint64_t num_blocks;
+    uint64_t index_offset;
+    uint64_t bitmap_offset;
+    uint64_t bitmap_bytes;
+    uint64_t prime_count;      // pi(limit)
+    uint64_t wheel;            // sieve parameters used to build it (informational)
+    uint64_t segment_bytes;
+};
+
+// Residue (mod 30) of each bit of a bitmap byte
+static const uint8_t WHEEL30_RESIDUE[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+// Primes 2, 3 and 5 live outside the bitmap
+inline long long wheel30_small_primes_upto(long long x) {
+    return (x >= 2 ? 1 : 0) + (x >= 3 ? 1 : 0) + (x >= 5 ? 1 : 0);
+}
+
+// ------------------------------------------------------------
+// Builder
+// ------------------------------------------------------------
+
+// Sieve [2, ctx.N] with the executor in options and store it as a prime
+// cache at path. ctx must start at 2 (build_sieve_context). Stores pi(N)
+// in count. Returns false if the file cannot be created.
+inline bool write_prime_cache(const SieveContext& ctx, const SieveOptions& options, SieveTrace& trace,
+                              const std::string& path, long long& count) {
+    if (ctx.A > 2) return false;
+
+    PrimeCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PRIME_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PRIME_CACHE_VERSION;
+    header.limit = (uint64_t)(ctx.N > 0 ? ctx.N : 0);
+    header.block_bytes = PRIME_CACHE_BLOCK_BYTES;
+    header.bitmap_bytes = header.limit / 30 + 1;
+    header.num_blocks = (header.bitmap_bytes + header.block_bytes - 1) / header.block_bytes;
+    header.index_offset = SIEVE_FILE_ALIGN;
+    header.bitmap_offset =
+        align_up(header.index_offset + (header.num_blocks + 1) * sizeof(uint64_t), SIEVE_FILE_ALIGN);
+    header.wheel = (uint64_t)ctx.wheel.modulus;
+    header.segment_bytes = (uint64_t)ctx.segment_bytes;
+
+    MappedFile file;
+    if (!file.create(path, (size_t)(header.bitmap_offset + header.bitmap_bytes))) return false;
+    uint8_t* bitmap = file.data() + header.bitmap_offset;
+
+    // Segments do not line up with 30, so the first and last byte of a
+    // segment can be shared with a neighbour: those use an atomic OR.
+    // Interior bytes belong to one worker and are plain stores.
+    auto store_segment = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+        long long first_byte = r.low / 30;
+        long long last_byte = (r.low + 2 * (r.num_bits - 1)) / 30;
+        state.segment.for_each_set([&](long long p) {
+            long long k = p / 30;
+            uint8_t bit = WHEEL30_BIT[p % 30];
+            if (k == first_byte || k == last_byte) {
+                __atomic_fetch_or(&bitmap[k], bit, __ATOMIC_RELAXED);
+            } else {
+                bitmap[k] |= bit;
+            }
+        });
+    };
+    count = run_executor(ctx, options, trace, store_segment);
+
+    // Block index: bitmap primes before each block
+    double phase_t0 = trace_now();
+    std::vector<uint64_t> index((size_t)header.num_blocks + 1, 0);
+    uint64_t running = 0;
+    for (uint64_t b = 0; b < header.num_blocks; b++) {
+        index[(size_t)b] = running;
+        uint64_t begin = b * header.block_bytes;
+        uint64_t end = std::min(begin + header.block_bytes, (uint64_t)header.bitmap_bytes);
+        running += (uint64_t)popcount_bytes(bitmap + begin, (size_t)(end - begin));
+    }
+    index.back() = running;
+    std::memcpy(file.data() + header.index_offset, index.data(), index.size() * sizeof(uint64_t));
+    trace.add_phase("cache_index_sec", trace_now() - phase_t0);
+
+    header.prime_count = (uint64_t)count;
+    std::memcpy(file.data(), &header, sizeof(header));
+    return true;
+}
+
+// ------------------------------------------------------------
+// Queries
+// ------------------------------------------------------------
+class PrimeCache {
+public:
+    // Map path and check its header. Returns false if it is not a valid cache.
+    // With a huge page policy other than Off, the index and bitmap are then
+    // copied into a HugePageBuffer and the file is unmapped (see memory()).
+    bool open(const std::string& path, HugePagePolicy policy = HugePagePolicy::Off) {
+        memory_.release();
+        bitmap_ = nullptr;
+        index_ = nullptr;
+        if (!file_.open_read(path) || file_.size() < sizeof(PrimeCacheHeader)) return false;
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, PRIME_CACHE_MAGIC, sizeof(header_.magic)) != 0) return false;
+        if (header_.version != PRIME_CACHE_VERSION || header_.block_bytes == 0) return false;
+        if (header_.bitmap_offset + header_.bitmap_bytes > file_.size()) return false;
+        if (header_.index_offset + (header_.num_blocks + 1) * sizeof(uint64_t) > header_.bitmap_offset) {
+            return false;
+        }
+        bitmap_ = file_.data() + header_.bitmap_offset;
+        index_ = reinterpret_cast<const uint64_t*>(file_.data() + header_.index_offset);
+
+        // Everything from the index on; the index offset is 8-byte aligned
+        size_t from = (size_t)header_.index_offset;
+        size_t bytes = (size_t)(header_.bitmap_offset + header_.bitmap_bytes) - from;
+        if (policy != HugePagePolicy::Off && memory_.allocate(bytes, policy)) {
+            std::memcpy(memory_.data(), file_.data() + from, bytes);
+            bitmap_ = memory_.data() + (header_.bitmap_offset - from);
+            index_ = reinterpret_cast<const uint64_t*>(memory_.data());
+            file_.close();
+        }
+        return true;
+    }
+
+    // The in-memory copy (empty when the file itself is mapped); its
+    // backing() and huge_bytes() tell which pages it really got
+    const HugePageBuffer& memory() const { return memory_; }
+
+    const PrimeCacheHeader& header() const { return header_; }
+    long long limit() const { return (long long)header_.limit; }
+    bool covers(long long x) const { return bitmap_ != nullptr && x <= limit(); }
+
+    // Is x prime? x must be covered (x <= limit()).
+    bool is_prime(long long x) const {
+        if (x < 7) return x == 2 || x == 3 || x == 5;
+        return (bitmap_[x / 30] & WHEEL30_BIT[x % 30]) != 0;
+    }
+
+    // Number of primes <= x. x must be covered (x <= limit()).
+    long long pi(long long x) const {
+        if (x < 7) return wheel30_small_primes_upto(x);
+        long long k = x / 30;
+        long long block = k / (long long)header_.block_bytes;
+        long long block_start = block * (long long)header_.block_bytes;
+
+        long long count = 3 + (long long)index_[block];
+        count += popcount_bytes(bitmap_ + block_start, (size_t)(k - block_start));
+        count += __builtin_popcount(bitmap_[k] & WHEEL30_UPTO[x % 30]);
+        return count;
+    }
+
+    // Number of primes in [A, B] (both covered)
+    long long count_range(long long A, long long B) const {
+        if (B < A) return 0;
+        return pi(B) - (A > 0 ? pi(A - 1) : 0);
+    }
+
+    // Call f(p) for every prime p <= x in increasing order. x must be covered.
+    template <typename F>
+    void for_each_prime(long long x, F&& f) const {
+        static const long long SMALL[3] = {2, 3, 5};
+        for (long long p : SMALL) {
+            if (p <= x) f(p);
+        }
+        for (long long k = 0; k <= x / 30; k++) {
+            uint8_t bits = bitmap_[k];
+            while (bits != 0) {
+                long long p = 30 * k + WHEEL30_RESIDUE[__builtin_ctz(bits)];
+                if (p > x) return;
+                f(p);
+                bits &= (uint8_t)(bits - 1);
+            }
+        }
+    }
+
+private:
+    MappedFile file_;
+    HugePageBuffer memory_;
+    PrimeCacheHeader header_;
+    const uint8_t* bitmap_ = nullptr;
+    const uint64_t* index_ = nullptr;
+};
@@ -1,220 +1,110 @@
 // ============================================================
-// sieve_serial.cpp — Beginner-Friendly Serial Segmented Sieve (Verbose Version)
+// sieve_serial.cpp — Beginner-Friendly Serial Segmented Sieve
 // - Uses Sieve of Eratosthenes
 // - Uses segmentation (processes in chunks)
 // - Uses odd-only optimization (skips even numbers except 2)
-// - Includes print statements (toggle VERBOSE=true/false)
+// - All sieving is done by the shared engine (see sieve_engine.hpp):
+//   word-packed bitsets, wheel pre-pattern, carried offsets for small
+//   primes, buckets for large primes, cache-sized segments
+// - This driver runs the engine with the serial executor
+// - Includes print statements (compile with -DSIEVE_VERBOSE=1)
+// - Optional per-thread counters dumped as JSON (see sieve_trace.hpp)
+// Usage: ./sieve_serial <N> [--wheel <modulus>] [--segment-bytes <B>] [--trace <file.json>]
+//                          [--presieve <limit>] [--simd auto|scalar|avx2|avx512]
+//        ./sieve_serial --range <A> <B> [--print] [...]   primes in [A, B] only
 // Output: N=<N> count=<count> time_sec=<time>
+//         A=<A> B=<B> count=<count> time_sec=<time>   (range mode)
+// With --print every prime is written first, one per line;
+// --output <file> [--output-format bitmap|gaps] writes a binary file instead;
+// --cache <file> answers from a prime cache, building it on a miss
+// --method lmo counts with the combinatorial pi(x) of sieve_lmo.hpp in
+// about N^(2/3) time instead of sieving (count only; same output line)
+// --stats adds a second line from the same pass (sieve_stats.hpp):
+//         twins=<n> cousins=<n> sexy=<n> triplets=<n> quadruplets=<n>
+//         max_gap=<gap> max_gap_start=<p>
+// --checkpoint <file> [--checkpoint-every <s>] [--deadline <s>] [--progress <s>]
+// counts as a resumable job (sieve_job.hpp) and adds a second line:
+//         complete=<0|1> segments_done=<n> segments_total=<n>
+//         resumed_segments=<n> segments_per_sec=<rate>
+// A stopped job (deadline, Ctrl-C, SIGTERM) exits with status 2 and its
+// count covers only the finished segments; run it again to resume
 // ============================================================
 
 #include <iostream>
 #include <vector>
-#include <cmath>
 #include <chrono>
-#include <cstdlib>
 #include <cstdio>
 #include <algorithm>
 
+#include "sieve_executors.hpp"
+#include "sieve_lmo.hpp"
+#include "sieve_stats.hpp"
+#include "sieve_cli.hpp"
+
 using namespace std;
 using namespace chrono;
 
-// Toggle verbose prints here
-static const bool VERBOSE = true;
-
-// Segment size = how many numbers we process at once
-static const long long SEG_SIZE = 1 << 20; // about 1 million numbers per segment
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
 
 // ------------------------------------------------------------
-// Step 1: Build base primes up to sqrt(N) using simple sieve
+// Step 1: Show the setup built by the engine
+// (base primes up to sqrt(N), wheel, segment geometry)
 // ------------------------------------------------------------
-vector<int> simple_sieve(int limit) {
-    if (VERBOSE) {
-        cout << "\nEntering simple_sieve(limit = " << limit << ")" << endl;
-    }
-
-    // is_prime[x] = true means x is currently assumed prime
-    vector<bool> is_prime(limit + 1, true);
-
-    // 0 and 1 are not prime
-    if (limit >= 0) is_prime[0] = false;
-    if (limit >= 1) is_prime[1] = false;
-
-    // Standard Sieve of Eratosthenes
-    for (int i = 2; (long long)i * i <= limit; i++) {
-        if (is_prime[i]) {
-            if (VERBOSE && i <= 20) {
-                cout << "Found base prime " << i
-                     << ". Marking multiples starting from " << (1LL * i * i)
-                     << " with step " << i << "." << endl;
-            }
-
-            // Start from i*i (optimization)
-            for (long long j = 1LL * i * i; j <= limit; j += i) {
-                is_prime[(int)j] = false;
-            }
-        }
-    }
-
-    // Collect primes into a list
-    vector<int> primes;
-    for (int i = 2; i <= limit; i++) {
-        if (is_prime[i]) {
-            primes.push_back(i);
-        }
-    }
-
-    if (VERBOSE) {
-        cout << "Total base primes found up to sqrt(N): " << primes.size() << endl;
-        cout << "First few base primes: ";
-        for (size_t i = 0; i < primes.size() && i < 15; i++) {
-            cout << primes[i];
-            if (i + 1 < primes.size() && i < 14) cout << ", ";
-        }
-        cout << endl;
+void print_context(const SieveContext& ctx) {
+    cout << "\nSetup for N = " << ctx.N << endl;
+    if (ctx.A > 0) cout << "Range starts at A = " << ctx.A << endl;
+    cout << "Segment size = " << ctx.seg_size << " numbers (" << ctx.segment_bytes << " bytes)" << endl;
+    cout << "Wheel modulus = " << ctx.wheel.modulus << endl;
+    cout << "Total base primes found up to sqrt(N): " << ctx.base_primes.size() << endl;
+    cout << "First few base primes: ";
+    for (size_t i = 0; i < ctx.base_primes.size() && i < 15; i++) {
+        cout << ctx.base_primes[i];
+        if (i + 1 < ctx.base_primes.size() && i < 14) cout << ", ";
     }
-
-    return primes;
+    cout << endl;
+    cout << "Large base primes handled by buckets: "
+         << (ctx.base_primes.size() - ctx.first_large) << endl;
+    cout << "\nStarting segmented sieve over odd numbers in range ["
+         << ctx.first_value << ".." << ctx.N << "]" << endl;
 }
 
 // ------------------------------------------------------------
-// Step 2: Segmented sieve over [2..N]
-// We process the full range in smaller chunks (segments)
+// Step 2: Segmented sieve over [2..N] (or [A..B]) with the serial executor
+// - print_primes: write every prime, in order, as segments finish
 // ------------------------------------------------------------
-long long sieve_serial(long long N) {
-    if (VERBOSE) {
-        cout << "\nStarting sieve_serial(N = " << N << ")" << endl;
-        cout << "Segment size = " << SEG_SIZE << endl;
-    }
-
-    if (N < 2) {
-        if (VERBOSE) {
-            cout << "N is less than 2, so there are no primes." << endl;
-        }
-        return 0;
-    }
-
-    // Count prime 2 separately (because we skip evens later)
-    long long prime_count = 1; // prime number 2
-
-    // We only need base primes up to sqrt(N)
-    int limit = (int)floor(sqrt((long double)N));
-    if (VERBOSE) {
-        cout << "floor(sqrt(N)) = " << limit << endl;
-    }
-
-    vector<int> base_primes = simple_sieve(limit);
-
-    if (VERBOSE) {
-        cout << "\nStarting segmented sieve over odd numbers in range [3.." << N << "]" << endl;
-    }
-
-    long long segment_number = 0;
-
-    // Process [3..N] in segments
-    // We will only store/check odd numbers in each segment
-    for (long long low = 3; low <= N; low += SEG_SIZE) {
-        long long high = min(low + SEG_SIZE - 1, N);
-        segment_number++;
-
-        // Make sure segment starts on an odd number
-        if (low % 2 == 0) low++;
-        if (high < low) continue;
-
-        // Number of odd values in this segment
-        long long odd_count = ((high - low) / 2) + 1;
-
-        if (VERBOSE) {
-            cout << "\nSegment " << segment_number
-                 << ": range [" << low << ", " << high << "]"
-                 << " | odd_count = " << odd_count << endl;
-        }
-
-        // segment[i] corresponds to number = low + 2*i
-        // true = prime candidate, false = composite
-        vector<bool> segment((size_t)odd_count, true);
-
-        int printed_prime_steps = 0;  // limit prints per segment
-
-        // Mark composites using base primes
-        for (int p : base_primes) {
-            if (p == 2) continue; // segment stores odd numbers only
-
-            long long p64 = (long long)p;
-            long long p2 = p64 * p64;
-
-            // If p^2 > high, no need to mark multiples for this segment
-            if (p2 > high) {
-                if (VERBOSE) {
-                    cout << "Stopping marking for this segment at p = " << p
-                         << " because p^2 = " << p2
-                         << " is greater than segment high = " << high << endl;
-                }
-                break;
-            }
-
-            // Find first multiple of p inside [low..high]
-            long long start = max(p2, ((low + p64 - 1) / p64) * p64);
-
-            // Make start odd, because segment stores only odd numbers
-            if (start % 2 == 0) {
-                start += p64;
-            }
-
-            if (VERBOSE && printed_prime_steps < 8) {
-                cout << "Using base prime p = " << p
-                     << " | p^2 = " << p2
-                     << " | first odd multiple in segment = " << start
-                     << " | step = " << (2 * p64) << endl;
-                printed_prime_steps++;
-            }
-
-            // Mark odd multiples of p in this segment
-            long long marks_for_p = 0;
-            for (long long x = start; x <= high; x += 2 * p64) {
-                long long idx = (x - low) / 2;
-                if (idx >= 0 && idx < odd_count) {
-                    if (segment[(size_t)idx]) { // count only first-time changes
-                        segment[(size_t)idx] = false;
-                        marks_for_p++;
-                    }
+long long sieve_serial(const SieveContext& ctx, bool print_primes, SieveTrace& trace) {
+    long long running_total = ctx.even_prime_count();
+    if (print_primes) print_even_prime(ctx);
+
+    auto report = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+        if (print_primes) print_segment_primes(state.segment);
+
+        if constexpr (VERBOSE) {
+            running_total += r.primes;
+            cout << "\nSegment " << (r.seg_id + 1)
+                 << ": range [" << r.low << ", " << (r.low + 2 * (r.num_bits - 1)) << "]"
+                 << " | odd_count = " << r.num_bits
+                 << " | marks = " << r.marks << endl;
+
+            // Print only first few primes in segment
+            int printed = 0;
+            for (long long i = 0; i < r.num_bits && printed < 10; i++) {
+                if (state.segment.test(i)) {
+                    cout << "  Prime found in this segment: " << (r.low + 2 * i) << endl;
+                    printed++;
                 }
             }
 
-            if (VERBOSE && p <= 19) {
-                cout << "Prime " << p << " marked " << marks_for_p
-                     << " odd composite numbers in this segment." << endl;
-            }
-        }
-
-        // Count remaining true values in this segment (these are primes)
-        long long segment_prime_count = 0;
-        if (VERBOSE) {
-            cout << "Counting surviving prime candidates in segment " << segment_number << "..." << endl;
+            cout << "Segment " << (r.seg_id + 1)
+                 << " complete. Primes in this segment = " << r.primes
+                 << " | Running total = " << running_total << endl;
         }
+    };
 
-        for (long long i = 0; i < odd_count; i++) {
-            if (segment[(size_t)i]) {
-                long long num = low + 2 * i;
-                if (num <= N) {
-                    prime_count++;
-                    segment_prime_count++;
-
-                    // Print only first few primes in segment
-                    if (VERBOSE && segment_prime_count <= 10) {
-                        cout << "  Prime found in this segment: " << num << endl;
-                    }
-                }
-            }
-        }
+    long long prime_count = run_serial(ctx, trace, report);
 
-        if (VERBOSE) {
-            cout << "Segment " << segment_number
-                 << " complete. Primes in this segment = " << segment_prime_count
-                 << " | Running total = " << prime_count << endl;
-        }
-    }
-
-    if (VERBOSE) {
+    if constexpr (VERBOSE) {
         cout << "\nFinished sieve_serial. Final prime count = " << prime_count << endl;
     }
 
@@ -222,25 +112,68 @@ long long sieve_serial(long long N) {
 }
 
 int main(int argc, char* argv[]) {
-    long long N = (argc > 1) ? atoll(argv[1]) : 1000000LL;
+    SieveArgs args;
+    args.N = 1000000LL;
+    args.options.threads = 1;
+    args.options.executor = SieveExecutor::Serial;
+    if (!parse_sieve_args(argc, argv, false, args)) return 1;
 
-    if (VERBOSE) {
+    if constexpr (VERBOSE) {
         cout << "Program started." << endl;
-        cout << "Input N = " << N << endl;
+        cout << "Input N = " << args.N << endl;
+        if (args.range) cout << "Input A = " << args.A << endl;
     }
 
+    SieveTrace trace;
+    if (!args.trace_path.empty()) trace.enable(1);
+
     auto t0 = high_resolution_clock::now();
-    long long count = sieve_serial(N);
+    SieveContext ctx;
+    long long count = 0;
+    PrimeStats stats;
+    JobResult job;
+    bool cache_hit = count_from_cache(args, count);
+    if (args.method == CountMethod::Lmo) {
+        count = args.range ? lmo_count_range(args.A, args.N, args.options, trace)
+                           : lmo_count(args.N, args.options, trace);
+        if (count < 0) return 1;
+    } else if (!cache_hit) {
+        build_context_from_args(args, ctx, trace);
+        if constexpr (VERBOSE) print_context(ctx);
+        if (!args.output_path.empty()) {
+            count = write_output_from_args(args, ctx, trace);
+        } else if (should_build_cache(args)) {
+            count = write_cache_from_args(args, ctx, trace);
+        } else if (args.stats) {
+            stats = prime_stats(ctx, args.options, trace);
+            count = stats.primes;
+        } else if (args.job_mode()) {
+            count = run_job_from_args(args, ctx, trace, job);
+        } else {
+            count = sieve_serial(ctx, args.print_primes, trace);
+        }
+        if (count < 0) return 1;
+    }
     auto t1 = high_resolution_clock::now();
 
     double elapsed = duration<double>(t1 - t0).count();
 
-    if (VERBOSE) {
+    if constexpr (VERBOSE) {
+        if (cache_hit) cout << "Answered from cache " << args.cache_path << endl;
         cout << "Execution time = " << elapsed << " seconds" << endl;
     }
 
+    if (!args.cache_path.empty()) trace.add_param("cache_hit", cache_hit ? 1 : 0);
+    finish_trace(trace, args, ctx, count, elapsed);
+
     // Machine-readable output for benchmark parser
-    printf("N=%lld count=%lld time_sec=%.6f\n", N, count, elapsed);
+    if (args.range) {
+        printf("A=%lld B=%lld count=%lld time_sec=%.6f\n", args.A, args.N, count, elapsed);
+    } else {
+        printf("N=%lld count=%lld time_sec=%.6f\n", args.N, count, elapsed);
+    }
+    if (args.stats) print_prime_stats(stats);
+    if (args.job_mode()) print_job_result(job);
 
-    return 0;
+    return (args.job_mode() && !job.complete()) ? 2 : 0;
 }
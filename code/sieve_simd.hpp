@@ -0,0 +1,260 @@
+// ============================================================
+// sieve_simd.hpp — Runtime-dispatched SIMD word kernels
+// Used by the segment bitset (counting) and the wheel/pre-sieve patterns
+// (segment initialization)
+// - Three word-array kernels: copy, AND with a pattern, popcount
+// - One test for batch trial division (sieve_factor.hpp): is any of n
+//   words divisible by an odd prime, given its inverse and limit
+// - Each has a scalar, an AVX2 and an AVX-512 version, compiled with
+//   target attributes so no -mavx flags are needed on the command line
+// - The best version the CPU supports is picked once at startup through
+//   CPUID (__builtin_cpu_supports); set_simd_level() can force a lower
+//   level for comparisons (--simd scalar|avx2|avx512)
+// - Popcount uses VPOPCNTQ when the CPU has AVX512_VPOPCNTDQ; AVX2
+//   keeps the hardware POPCNT loop, which already runs at one word per
+//   cycle
+// ============================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIEVE_SIMD_X86 1
+#else
+#define SIEVE_SIMD_X86 0
+#endif
+
+enum class SimdLevel { Scalar = 0, AVX2 = 1, AVX512 = 2 };
+
+struct SimdKernels {
+    SimdLevel level = SimdLevel::Scalar;
+    void (*copy_words)(uint64_t* dst, const uint64_t* src, size_t n) = nullptr;
+    void (*and_words)(uint64_t* dst, const uint64_t* src, size_t n) = nullptr;  // dst &= src
+    long long (*count_words)(const uint64_t* src, size_t n) = nullptr;
+    // Any src[i] with src[i] * inv <= limit (mod 2^64), i.e. divisible by p
+    // for inv = p^-1 mod 2^64 and limit = (2^64 - 1) / p
+    bool (*any_divisible)(const uint64_t* src, size_t n, uint64_t inv, uint64_t limit) = nullptr;
+};
+
+// ------------------------------------------------------------
+// Scalar
+// ------------------------------------------------------------
+inline void copy_words_scalar(uint64_t* dst, const uint64_t* src, size_t n) {
+    std::memcpy(dst, src, n * sizeof(uint64_t));
+}
+
+inline void and_words_scalar(uint64_t* dst, const uint64_t* src, size_t n) {
+    for (size_t i = 0; i < n; i++) dst[i] &= src[i];
+}
+
+#if SIEVE_SIMD_X86
+__attribute__((target("popcnt")))
+#endif
+inline long long count_words_scalar(const uint64_t* src, size_t n) {
+    long long total = 0;
+    for (size_t i = 0; i < n; i++) total += __builtin_popcountll(src[i]);
+    return total;
+}
+
+inline bool any_divisible_scalar(const uint64_t* src, size_t n, uint64_t inv, uint64_t limit) {
+    bool any = false;
+    for (size_t i = 0; i < n; i++) any |= src[i] * inv <= limit;
+    return any;
+}
+
+#if SIEVE_SIMD_X86
+// ------------------------------------------------------------
+// AVX2: 4 words per instruction
+// ------------------------------------------------------------
+__attribute__((target("avx2")))
+inline void copy_words_avx2(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+    for (; i < n; i++) dst[i] = src[i];
+}
+
+__attribute__((target("avx2")))
+inline void and_words_avx2(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(a, b));
+    }
+    for (; i < n; i++) dst[i] &= src[i];
+}
+
+// No 64-bit multiply in AVX2: lo*lo + ((lo*hi + hi*lo) << 32) from 32-bit
+// multiplies; unsigned compare through the sign-flipped signed one
+__attribute__((target("avx2")))
+inline bool any_divisible_avx2(const uint64_t* src, size_t n, uint64_t inv, uint64_t limit) {
+    const __m256i b = _mm256_set1_epi64x((long long)inv);
+    const __m256i b_hi = _mm256_set1_epi64x((long long)(inv >> 32));
+    const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    const __m256i lim = _mm256_xor_si256(_mm256_set1_epi64x((long long)limit), sign);
+    __m256i above_all = _mm256_set1_epi64x(-1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, b_hi),
+                                         _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+        __m256i prod = _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+        above_all = _mm256_and_si256(above_all, _mm256_cmpgt_epi64(_mm256_xor_si256(prod, sign), lim));
+    }
+    bool any = _mm256_movemask_epi8(above_all) != -1;
+    for (; i < n; i++) any |= src[i] * inv <= limit;
+    return any;
+}
+
+// ------------------------------------------------------------
+// AVX-512: 8 words per instruction, masked tail
+// ------------------------------------------------------------
+__attribute__((target("avx512f")))
+inline void copy_words_avx512(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_si512(dst + i, _mm512_loadu_si512(src + i));
+    }
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi64(dst + i, m, _mm512_maskz_loadu_epi64(m, src + i));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void and_words_avx512(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i a = _mm512_loadu_si512(dst + i);
+        __m512i b = _mm512_loadu_si512(src + i);
+        _mm512_storeu_si512(dst + i, _mm512_and_si512(a, b));
+    }
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        __m512i a = _mm512_maskz_loadu_epi64(m, dst + i);
+        __m512i b = _mm512_maskz_loadu_epi64(m, src + i);
+        _mm512_mask_storeu_epi64(dst + i, m, _mm512_and_si512(a, b));
+    }
+}
+
+// Same 32-bit multiply split as AVX2: VPMULLQ is 3 uops and slower here.
+// The zero-masked forms (all lanes on) compile to the same instructions;
+// the plain ones trip a false -Wmaybe-uninitialized in GCC 12's headers.
+__attribute__((target("avx512f")))
+inline bool any_divisible_avx512(const uint64_t* src, size_t n, uint64_t inv, uint64_t limit) {
+    const __m512i b = _mm512_set1_epi64((long long)inv);
+    const __m512i b_hi = _mm512_set1_epi64((long long)(inv >> 32));
+    const __m512i lim = _mm512_set1_epi64((long long)limit);
+    __mmask8 hits = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i a = _mm512_loadu_si512(src + i);
+        __m512i cross = _mm512_add_epi64(_mm512_maskz_mul_epu32(0xFF, a, b_hi),
+                                         _mm512_maskz_mul_epu32(0xFF, _mm512_maskz_srli_epi64(0xFF, a, 32), b));
+        __m512i prod = _mm512_add_epi64(_mm512_maskz_mul_epu32(0xFF, a, b),
+                                        _mm512_maskz_slli_epi64(0xFF, cross, 32));
+        hits |= _mm512_cmple_epu64_mask(prod, lim);
+    }
+    bool any = hits != 0;
+    for (; i < n; i++) any |= src[i] * inv <= limit;
+    return any;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+inline long long count_words_avx512(const uint64_t* src, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(src + i)));
+    }
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n - i)) - 1);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(m, src + i)));
+    }
+    // Lanes summed by hand: GCC 12's _mm512_reduce_add_epi64 trips -Wuninitialized
+    alignas(64) long long lanes[8];
+    _mm512_store_si512(lanes, acc);
+    long long total = 0;
+    for (long long v : lanes) total += v;
+    return total;
+}
+#endif
+
+// ------------------------------------------------------------
+// Dispatch
+// ------------------------------------------------------------
+
+// Highest level this CPU supports
+inline SimdLevel detect_simd_level() {
+#if SIEVE_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+inline SimdKernels make_simd_kernels(SimdLevel level) {
+    SimdKernels k;
+    k.level = SimdLevel::Scalar;
+    k.copy_words = copy_words_scalar;
+    k.and_words = and_words_scalar;
+    k.count_words = count_words_scalar;
+    k.any_divisible = any_divisible_scalar;
+#if SIEVE_SIMD_X86
+    if (level >= SimdLevel::AVX2) {
+        k.level = SimdLevel::AVX2;
+        k.copy_words = copy_words_avx2;
+        k.and_words = and_words_avx2;
+        k.any_divisible = any_divisible_avx2;
+    }
+    if (level >= SimdLevel::AVX512) {
+        k.level = SimdLevel::AVX512;
+        k.copy_words = copy_words_avx512;
+        k.and_words = and_words_avx512;
+        if (__builtin_cpu_supports("avx512vpopcntdq")) k.count_words = count_words_avx512;
+        k.any_divisible = any_divisible_avx512;
+    }
+#else
+    (void)level;
+#endif
+    return k;
+}
+
+// The kernels in use (best supported level unless overridden)
+inline SimdKernels& simd_kernels() {
+    static SimdKernels kernels = make_simd_kernels(detect_simd_level());
+    return kernels;
+}
+
+// Force a SIMD level. Returns false (and changes nothing) if the CPU lacks it.
+// Call before any sieving starts; the kernels are not swapped under running threads.
+inline bool set_simd_level(SimdLevel level) {
+    if (level > detect_simd_level()) return false;
+    simd_kernels() = make_simd_kernels(level);
+    return true;
+}
+
+inline const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::Scalar:
+        default:                return "scalar";
+    }
+}
+
+inline bool parse_simd_level(const std::string& name, SimdLevel& out) {
+    if (name == "scalar") { out = SimdLevel::Scalar; return true; }
+    if (name == "avx2")   { out = SimdLevel::AVX2; return true; }
+    if (name == "avx512") { out = SimdLevel::AVX512; return true; }
+    return false;
+}
@@ -0,0 +1,112 @@
+// ============================================================
+// sieve_small_primes.hpp — Small-prime and wheel tables built at compile time
+// Shared by sieve_base_primes.hpp and sieve_wheel.hpp
+// - SMALL_PRIMES: every prime below 2^16 (6542 of them), from a constexpr
+//   odd-only sieve. Base primes for N < 2^32 and the seed primes of the
+//   parallel generator are a prefix of this table, so no sieve runs at
+//   startup for them.
+// - WheelTable<M>: the wheel pattern of modulus M in the exact layout
+//   WheelPattern::build() stores (bit k = odd number 2k+1 coprime to the
+//   wheel primes, repeated to at least 4096 bits, plus 64 bits of
+//   wrap-around). The supported wheels up to 30030 are copied from these
+//   tables; 510510 (255255 bits) is still built at runtime, to keep
+//   compile times short.
+// All tables are checked with static_assert against known values.
+// ============================================================
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Every prime below this bound is in SMALL_PRIMES
+static constexpr long long SMALL_PRIME_BOUND = 1LL << 16;
+
+// ------------------------------------------------------------
+// Primes below 2^16
+// ------------------------------------------------------------
+
+// Odd-only sieve: entry i is true when 2i+1 is prime
+constexpr std::array<bool, SMALL_PRIME_BOUND / 2> small_odd_sieve() {
+    std::array<bool, SMALL_PRIME_BOUND / 2> is_prime{};
+    for (size_t i = 1; i < is_prime.size(); i++) is_prime[i] = true;   // 1 is not prime
+    for (long long p = 3; p * p < SMALL_PRIME_BOUND; p += 2) {
+        if (!is_prime[(size_t)(p / 2)]) continue;
+        for (long long m = p * p; m < SMALL_PRIME_BOUND; m += 2 * p) is_prime[(size_t)(m / 2)] = false;
+    }
+    return is_prime;
+}
+
+constexpr size_t count_small_primes() {
+    size_t count = 1;   // 2
+    std::array<bool, SMALL_PRIME_BOUND / 2> is_prime = small_odd_sieve();
+    for (bool b : is_prime) count += b ? 1 : 0;
+    return count;
+}
+
+static constexpr size_t SMALL_PRIME_COUNT = count_small_primes();
+
+constexpr std::array<uint32_t, SMALL_PRIME_COUNT> make_small_primes() {
+    std::array<uint32_t, SMALL_PRIME_COUNT> primes{};
+    std::array<bool, SMALL_PRIME_BOUND / 2> is_prime = small_odd_sieve();
+    size_t n = 0;
+    primes[n++] = 2;
+    for (size_t i = 1; i < is_prime.size(); i++) {
+        if (is_prime[i]) primes[n++] = (uint32_t)(2 * i + 1);
+    }
+    return primes;
+}
+
+static constexpr std::array<uint32_t, SMALL_PRIME_COUNT> SMALL_PRIMES = make_small_primes();
+
+static_assert(SMALL_PRIME_COUNT == 6542, "pi(2^16) is 6542");
+static_assert(SMALL_PRIMES[6541] == 65521, "largest prime below 2^16 is 65521");
+
+// ------------------------------------------------------------
+// Wheel patterns
+// ------------------------------------------------------------
+
+// Odd primes folded into the wheel of modulus M (M = 2 * 3 * 5 * ...)
+constexpr int wheel_prime_count(long long modulus) {
+    const int wheel_primes[] = {3, 5, 7, 11, 13, 17};
+    long long m = 2;
+    int count = 0;
+    for (int q : wheel_primes) {
+        if (m >= modulus) break;
+        m *= q;
+        count++;
+    }
+    return m == modulus ? count : -1;
+}
+
+template <long long M>
+struct WheelTable {
+    static_assert(wheel_prime_count(M) > 0, "M must be 6, 30, 210, 2310, 30030 or 510510");
+
+    // Same layout rules as WheelPattern::build()
+    static constexpr long long base_period = M / 2;
+    static constexpr long long period = ((4096 + base_period - 1) / base_period) * base_period;
+    static constexpr long long stored_bits = period + 64;
+    static constexpr size_t num_words = (size_t)((stored_bits + 63) / 64) + 1;
+
+    static constexpr std::array<uint64_t, num_words> make() {
+        const int wheel_primes[] = {3, 5, 7, 11, 13, 17};
+        std::array<uint64_t, num_words> bits{};
+        for (long long k = 0; k < stored_bits; k++) {
+            long long n = 2 * k + 1;
+            bool coprime = true;
+            for (int i = 0; i < wheel_prime_count(M); i++) {
+                if (n % wheel_primes[i] == 0) coprime = false;
+            }
+            if (coprime) bits[(size_t)(k >> 6)] |= 1ULL << (k & 63);
+        }
+        return bits;
+    }
+
+    static constexpr std::array<uint64_t, num_words> bits = make();
+};
+
+// Bits 0..9 are the odd numbers 1, 3, ..., 19: coprime to 2*3*5*7 are 1, 11, 13, 17, 19
+static_assert((WheelTable<210>::bits[0] & 0x3FF) == 0x361, "wheel 210 pattern");
+static_assert(WheelTable<30030>::period == 15015, "wheel 30030 period");
@@ -0,0 +1,86 @@
+// ============================================================
+// sieve_sophie.cpp — Sophie Germain and safe-prime counts in C++
+// C++ version of the notebook's crypto extension
+// (find_sophie_germain_primes / find_safe_primes, Table 7)
+// - Sieves p and its companion 2p + 1 together and ANDs the two bitmaps
+//   word by word (see sieve_sophie.hpp), instead of looking 2p + 1 up
+//   in a set of primes
+// - All sieving is done by the shared engine (see sieve_engine.hpp)
+// Usage: ./sieve_sophie <N> [threads] [--wheel <modulus>] [--segment-bytes <B>]
+//                      [--presieve <limit>] [--simd auto|scalar|avx2|avx512]
+//                      [--print] [--trace <file.json>]
+// --segment-bytes is split between a p-segment and its twice as long
+// q-segment; --print writes every SG prime p in order (one thread)
+// Output: N=<N> threads=<T> primes=<pi(N)> sophie_germain=<count> safe=<count> time_sec=<time>
+// ============================================================
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+
+#include "sieve_sophie.hpp"
+#include "sieve_cli.hpp"
+
+using namespace std;
+using namespace chrono;
+
+// Verbose prints are compiled in only with -DSIEVE_VERBOSE=1
+static constexpr bool VERBOSE = (SIEVE_VERBOSE != 0);
+
+int main(int argc, char* argv[]) {
+    SieveArgs args;
+    args.N = 10000000LL;
+    args.options.threads = 1;
+    if (!parse_sieve_args(argc, argv, true, args)) return 1;
+    if (args.range || !args.output_path.empty() || !args.cache_path.empty() ||
+            args.method != CountMethod::Sieve || args.stats || args.job_mode()) {
+        fprintf(stderr, "--range, --output, --cache, --method lmo, --stats and jobs (--checkpoint, --deadline, "
+                        "--progress) are not supported by sieve_sophie\n");
+        return 1;
+    }
+    if (args.options.threads < 1) args.options.threads = 1;
+    if (args.print_primes && args.options.threads > 1) {
+        fprintf(stderr, "--print runs on one thread; ignoring threads=%d\n", args.options.threads);
+        args.options.threads = 1;
+    }
+
+    SieveTrace trace;
+    if (!args.trace_path.empty()) trace.enable(args.options.threads);
+
+    auto t0 = high_resolution_clock::now();
+    SophieContext sctx;
+    build_sophie_context(args.N, args.options, sctx, trace);
+
+    if constexpr (VERBOSE) {
+        cout << "SG candidates p in [3, " << sctx.p.N << "], " << sctx.num_segments()
+             << " segments of " << sctx.p.segment_bytes << " + " << sctx.q.segment_bytes << " bytes" << endl;
+        cout << "Base primes up to sqrt(N) = " << sctx.q.base_primes.size() << endl;
+    }
+
+    // --print: 2 first (the pair 2, 5), then each segment's SG primes in order
+    if (args.print_primes && sctx.even_pair_count() > 0) printf("2\n");
+    auto report = [&](int, const SieveThreadState& state, const SegmentResult&) {
+        if (args.print_primes) print_segment_primes(state.segment);
+    };
+
+    SophieCounts counts = run_sophie_germain(sctx, args.options.threads, trace, report,
+                                             args.options.max_run_segments);
+    auto t1 = high_resolution_clock::now();
+
+    double elapsed = duration<double>(t1 - t0).count();
+
+    if constexpr (VERBOSE) {
+        double density = counts.primes > 0 ? 100.0 * counts.sophie_germain / counts.primes : 0.0;
+        cout << "SG density = " << density << " % of all primes up to N" << endl;
+        cout << "Execution time = " << elapsed << " seconds" << endl;
+    }
+
+    trace.add_param("sophie_germain", counts.sophie_germain);
+    trace.add_param("safe", counts.safe);
+    finish_trace(trace, args, sctx.p, counts.primes, elapsed);
+
+    printf("N=%lld threads=%d primes=%lld sophie_germain=%lld safe=%lld time_sec=%.6f\n",
+           args.N, args.options.threads, counts.primes, counts.sophie_germain, counts.safe, elapsed);
+
+    return 0;
+}
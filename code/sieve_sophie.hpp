@@ -0,0 +1,203 @@
+// ============================================================
+// sieve_sophie.hpp — Fused Sophie Germain / safe-prime sieve
+// Used by sieve_sophie.cpp
+// - A Sophie Germain prime p has 2p + 1 prime too; q = 2p + 1 is then a
+//   safe prime. As in the notebook, SG primes are counted for 2p + 1 <= N,
+//   so for [2, N] there are exactly as many SG primes as safe primes.
+// - Two contexts of the shared engine sieve side by side:
+//     p: the odd numbers in [3, M] with M = (N - 1) / 2
+//     q: the companion windows [2L + 1, 2H + 1] of every p-segment [L, H]
+//   The q-segments are twice as long, so p-segment s and q-segment s
+//   always pair up, and both are sieved by the normal segment kernel
+//   (wheel, pre-sieve, offsets, buckets)
+// - p = L + 2i pairs with q = 2L + 1 + 4i, which is bit 2i of the
+//   q-segment: the even bits of two q-words are packed into one word and
+//   ANDed with the p-word, leaving 1 exactly for the SG primes
+// - The q-segments cover every odd number up to N, so pi(N) comes for free
+// Workers pull runs of segments from an atomic counter (as in
+// run_thread_pool); each keeps one thread state per context.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+struct SophieContext {
+    long long N = 0;       // safe primes q <= N, SG primes p with 2p + 1 <= N
+    SieveContext p;        // candidates p in [3, (N - 1) / 2]
+    SieveContext q;        // companions 2p + 1; q-segment s pairs with p-segment s
+
+    long long num_segments() const { return p.num_segments; }
+
+    // The pair (2, 5): p = 2 is even, so the odd-only segments never see it
+    long long even_pair_count() const { return N >= 5 ? 1 : 0; }
+
+    // Primes 2, 3 and 5, which lie below the first q-segment (q starts at 7)
+    long long small_prime_count() const { return N >= 5 ? 3 : (N >= 3 ? 2 : (N >= 2 ? 1 : 0)); }
+};
+
+struct SophieCounts {
+    long long primes = 0;           // pi(N)
+    long long sophie_germain = 0;   // p with p and 2p + 1 prime, 2p + 1 <= N
+    long long safe = 0;             // q <= N with q and (q - 1) / 2 prime
+};
+
+// p-segment size: half the requested (or detected) size, so one p-segment
+// plus its q-segment take up what a single segment would
+inline long long sophie_segment_bytes(const SieveOptions& options) {
+    long long bytes = options.segment_bytes > 0 ? options.segment_bytes
+                                                : default_segment_bytes(detect_cache_info());
+    return normalize_segment_bytes(std::min(bytes / 2, MAX_SEGMENT_BYTES / 2));
+}
+
+// Build both contexts for N. Returns false if the wheel modulus is unsupported.
+inline bool build_sophie_context(long long N, const SieveOptions& options, SophieContext& sctx,
+                                 SieveTrace& trace) {
+    sctx.N = N;
+    long long M = N >= 1 ? (N - 1) / 2 : 0;
+
+    SieveOptions p_options = options;
+    p_options.segment_bytes = sophie_segment_bytes(options);
+    if (!prepare_range_context(0, M, p_options, sctx.p)) return false;
+
+    // q = 2p + 1 for every odd p of the p-segments, in twice as many bits
+    SieveOptions q_options = p_options;
+    q_options.segment_bytes = 2 * p_options.segment_bytes;
+    prepare_range_context(2 * sctx.p.first_value + 1, 2 * M + 1, q_options, sctx.q);
+    if (sctx.q.num_segments > sctx.p.num_segments) sctx.q.num_segments = sctx.p.num_segments;
+
+    double phase_t0 = trace_now();
+    std::vector<uint32_t> primes = generate_base_primes(integer_sqrt(std::max(2 * M + 1, 0LL)), options.threads);
+    trace.add_phase("base_primes_sec", trace_now() - phase_t0);
+
+    set_base_primes(sctx.p, primes);
+    set_base_primes(sctx.q, std::move(primes));
+    return true;
+}
+
+// The even bits of x (bits 0, 2, ..., 62) packed into the low 32 bits
+inline uint64_t pack_even_bits(uint64_t x) {
+    x &= 0x5555555555555555ULL;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+    return x;
+}
+
+// Keep in p only the bits whose companion 2p + 1 survived in q.
+// Returns the number of SG primes left in p.
+inline long long and_companion(SegmentBitset& p, const SegmentBitset& q) {
+    size_t p_words = p.word_count();
+    size_t q_words = q.word_count();
+    for (size_t w = 0; w < p_words; w++) {
+        uint64_t lo = 2 * w < q_words ? q.words[2 * w] : 0;
+        uint64_t hi = 2 * w + 1 < q_words ? q.words[2 * w + 1] : 0;
+        p.words[w] &= pack_even_bits(lo) | (pack_even_bits(hi) << 32);
+    }
+    return p.count();
+}
+
+// One worker's state: a thread state for each context
+struct SophieThreadState {
+    SieveThreadState p;
+    SieveThreadState q;
+
+    void init(const SophieContext& sctx) {
+        p.init(sctx.p.wheel, sctx.p.seg_bits);
+        q.init(sctx.q.wheel, sctx.q.seg_bits);
+    }
+};
+
+// Sieve the run [seg_begin, seg_end) of both contexts and AND them together.
+// visit(tid, state.p, result) is called after each segment, with state.p.segment
+// holding that segment's SG primes (result.primes = their count).
+template <typename Visitor>
+SophieCounts sophie_run(SophieThreadState& state, const SophieContext& sctx,
+                        long long seg_begin, long long seg_end,
+                        int tid, ThreadTrace* tt, Visitor& visit) {
+    begin_run(state.p, sctx.p, seg_begin, seg_end);
+    begin_run(state.q, sctx.q, seg_begin, seg_end);
+    if (tt) tt->runs++;
+
+    SophieCounts counts;
+    for (long long s = seg_begin; s < seg_end; s++) {
+        double seg_t0 = tt ? trace_now() : 0.0;
+        SegmentResult r = sieve_segment(state.p, sctx.p, s);
+        SegmentResult rq = sieve_segment(state.q, sctx.q, s);
+        counts.primes += rq.primes;
+
+        r.marks += rq.marks;
+        r.primes = and_companion(state.p.segment, state.q.segment);
+        counts.sophie_germain += r.primes;
+        if (tt) tt->record_segment(trace_now() - seg_t0, r.marks, r.primes);
+
+        visit(tid, state.p, r);
+    }
+    return counts;
+}
+
+// Count primes, SG primes and safe primes of sctx on num_threads workers.
+// With one thread the segments are visited in order (for printing).
+template <typename Visitor>
+SophieCounts run_sophie_germain(const SophieContext& sctx, int num_threads, SieveTrace& trace,
+                                Visitor&& visit, long long max_run = MAX_RUN_SEGMENTS) {
+    SophieCounts total;
+    total.primes = sctx.small_prime_count();
+    total.sophie_germain = sctx.even_pair_count();
+    long long num_segments = sctx.num_segments();
+    if (num_threads < 1) num_threads = 1;
+
+    if (num_segments > 0) {
+        long long run_length = plan_run_length(sctx.p, num_threads, max_run);
+        long long num_runs = (num_segments + run_length - 1) / run_length;
+
+        std::atomic<long long> next_run(0);
+        std::vector<SophieCounts> counts((size_t)num_threads);
+
+        auto worker = [&](int tid) {
+            ThreadTrace* tt = trace.thread(tid);
+            double region_t0 = tt ? trace_now() : 0.0;
+
+            SophieThreadState state;
+            state.init(sctx);
+
+            SophieCounts local;
+            for (;;) {
+                long long run_id = next_run.fetch_add(1, std::memory_order_relaxed);
+                if (run_id >= num_runs) break;
+                long long run_begin = run_id * run_length;
+                long long run_end = std::min(run_begin + run_length, num_segments);
+                SophieCounts c = sophie_run(state, sctx, run_begin, run_end, tid, tt, visit);
+                local.primes += c.primes;
+                local.sophie_germain += c.sophie_germain;
+            }
+            counts[(size_t)tid] = local;
+
+            if (tt) tt->region_sec = trace_now() - region_t0;
+        };
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < num_threads; t++) pool.emplace_back(worker, t);
+        worker(0);
+        for (std::thread& th : pool) th.join();
+
+        for (const SophieCounts& c : counts) {
+            total.primes += c.primes;
+            total.sophie_germain += c.sophie_germain;
+        }
+    }
+
+    // Every SG prime p has exactly one safe prime 2p + 1 <= N, and back
+    total.safe = total.sophie_germain;
+    return total;
+}
@@ -0,0 +1,241 @@
+// ============================================================
+// sieve_stats.hpp — Prime gap and twin / k-tuple statistics on the bitmaps
+// Used by sieve_serial.cpp and sieve_openmp.cpp (--stats)
+// Computed in the same pass as the count, from each segment's packed
+// bitmap (bit i = low + 2i), without listing the primes:
+// - Pairs and k-tuples: the bitmap ANDed with copies of itself shifted
+//   by 1..4 bits (p+2 .. p+8), then popcounts
+// - Gaps: the lowest / highest set bit of each word gives the gaps
+//   between words. Gaps inside a word (at most 126) are only walked
+//   while the segment's largest gap is still smaller than that.
+// - Tuples and gaps that cross a segment boundary are added when two
+//   neighbouring pieces are joined (append): each piece keeps its first
+//   and last prime and its first and last 4 bits
+// - Each worker extends one open piece while its segments are
+//   consecutive (a run); the pieces are joined in segment order after
+//   the run, so any executor works
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+// Counts of prime patterns, by offsets from p (all odd primes here)
+struct PrimeTupleCounts {
+    long long twins = 0;        // (p, p+2)
+    long long cousins = 0;      // (p, p+4)
+    long long sexy = 0;         // (p, p+6)
+    long long triplets = 0;     // (p, p+2, p+6) or (p, p+4, p+6)
+    long long quadruplets = 0;  // (p, p+2, p+6, p+8)
+
+    void add(const PrimeTupleCounts& o) {
+        twins += o.twins;
+        cousins += o.cousins;
+        sexy += o.sexy;
+        triplets += o.triplets;
+        quadruplets += o.quadruplets;
+    }
+};
+
+// Add (sign = 1) or remove (sign = -1) the patterns that start at a set
+// bit of word x, where next holds the 64 numbers that follow it
+inline void add_tuples(uint64_t x, uint64_t next, PrimeTupleCounts& c, long long sign = 1) {
+    uint64_t s1 = (x >> 1) | (next << 63);   // bit i: p+2 is prime
+    uint64_t s2 = (x >> 2) | (next << 62);   // p+4
+    uint64_t s3 = (x >> 3) | (next << 61);   // p+6
+    uint64_t s4 = (x >> 4) | (next << 60);   // p+8
+    uint64_t x3 = x & s3;
+    c.twins += sign * __builtin_popcountll(x & s1);
+    c.cousins += sign * __builtin_popcountll(x & s2);
+    c.sexy += sign * __builtin_popcountll(x3);
+    c.triplets += sign * (__builtin_popcountll(x3 & s1) + __builtin_popcountll(x3 & s2));
+    c.quadruplets += sign * __builtin_popcountll(x3 & s1 & s4);
+}
+
+// Statistics of a stretch of consecutive odd numbers (one segment, a
+// run of segments, or the whole range)
+struct PrimeStats {
+    long long low = 0;                 // first odd number covered
+    long long num_bits = 0;            // odd numbers covered
+    long long primes = 0;
+    long long first = -1, last = -1;   // smallest / largest prime, -1 if none
+    long long max_gap = 0;             // largest gap between consecutive primes
+    long long max_gap_start = -1;      // the prime before it (first such gap), -1 if none
+    PrimeTupleCounts tuples;
+    uint64_t head = 0;                 // the first 4 numbers (bit 0 = low)
+    uint64_t tail = 0;                 // the last 4 numbers (bit 3 = the last one)
+
+    // Join the stretch that starts right after this one
+    void append(const PrimeStats& right) {
+        if (right.num_bits == 0) return;
+        if (num_bits == 0) {
+            *this = right;
+            return;
+        }
+
+        // Patterns that start in this stretch's last 4 numbers and end in right's
+        add_tuples(tail << 60, right.head, tuples);
+        add_tuples(tail << 60, 0, tuples, -1);
+        tuples.add(right.tuples);
+
+        // The gap across the boundary, then right's own; ties keep the first
+        if (last >= 0 && right.first >= 0 && right.first - last > max_gap) {
+            max_gap = right.first - last;
+            max_gap_start = last;
+        }
+        if (right.max_gap > max_gap) {
+            max_gap = right.max_gap;
+            max_gap_start = right.max_gap_start;
+        }
+        if (first < 0) first = right.first;
+        if (right.last >= 0) last = right.last;
+
+        // Short stretches (fewer than 4 numbers) take bits from their neighbour
+        if (num_bits < 4) head = (head | (right.head << num_bits)) & 0xF;
+        tail = right.num_bits >= 4 ? right.tail : ((tail | (right.head << 4)) >> right.num_bits) & 0xF;
+
+        num_bits += right.num_bits;
+        primes += right.primes;
+    }
+};
+
+// Statistics of one sieved segment (tail bits past num_bits are 0)
+inline PrimeStats segment_stats(const SegmentBitset& seg, long long low) {
+    PrimeStats s;
+    s.low = low;
+    s.num_bits = seg.num_bits;
+    size_t n = seg.word_count();
+    if (n == 0) return s;
+
+    long long last_pos = -1, gap_bits = 0, gap_pos = -1;
+    for (size_t w = 0; w < n; w++) {
+        uint64_t x = seg.words[w];
+        if (x == 0) continue;
+        add_tuples(x, w + 1 < n ? seg.words[w + 1] : 0, s.tuples);
+        s.primes += __builtin_popcountll(x);
+
+        long long base = (long long)w * 64;
+        long long pos = base + __builtin_ctzll(x);
+        if (s.first < 0) s.first = low + 2 * pos;
+        if (last_pos >= 0 && pos - last_pos > gap_bits) {
+            gap_bits = pos - last_pos;
+            gap_pos = last_pos;
+        }
+        // A gap inside one word is at most 63 bits, so it can only win
+        // while the segment's largest gap is shorter
+        if (gap_bits < 63) {
+            long long prev = pos;
+            for (uint64_t rest = x & (x - 1); rest != 0; rest &= rest - 1) {
+                long long next = base + __builtin_ctzll(rest);
+                if (next - prev > gap_bits) {
+                    gap_bits = next - prev;
+                    gap_pos = prev;
+                }
+                prev = next;
+            }
+        }
+        last_pos = base + 63 - __builtin_clzll(x);
+    }
+    if (last_pos >= 0) s.last = low + 2 * last_pos;
+    if (gap_pos >= 0) {
+        s.max_gap = 2 * gap_bits;
+        s.max_gap_start = low + 2 * gap_pos;
+    }
+
+    s.head = seg.words[0] & 0xF;
+    if (s.num_bits >= 4) {
+        long long pos = s.num_bits - 4;
+        size_t w = (size_t)(pos >> 6);
+        int off = (int)(pos & 63);
+        uint64_t v = seg.words[w] >> off;
+        if (off > 60) v |= seg.words[w + 1] << (64 - off);
+        s.tail = v & 0xF;
+    } else {
+        s.tail = (seg.words[0] << (4 - s.num_bits)) & 0xF;
+    }
+    return s;
+}
+
+// ------------------------------------------------------------
+// Collecting the pieces of a run (visitor for any executor)
+// ------------------------------------------------------------
+class PrimeStatsCollector {
+public:
+    explicit PrimeStatsCollector(int num_threads) : threads_((size_t)std::max(1, num_threads)) {}
+
+    void operator()(int tid, const SieveThreadState& state, const SegmentResult& r) {
+        ThreadPieces& mine = threads_[(size_t)tid];
+        if (r.seg_id != mine.next_seg) {
+            close(mine);
+            mine.begin = r.seg_id;
+        }
+        mine.open.append(segment_stats(state.segment, r.low));
+        mine.next_seg = r.seg_id + 1;
+    }
+
+    // Join every piece in segment order (call after the run)
+    PrimeStats finish() {
+        std::vector<std::pair<long long, PrimeStats>> pieces;
+        for (ThreadPieces& t : threads_) {
+            close(t);
+            for (std::pair<long long, PrimeStats>& p : t.closed) pieces.push_back(std::move(p));
+            t.closed.clear();
+        }
+        std::sort(pieces.begin(), pieces.end(),
+                  [](const std::pair<long long, PrimeStats>& a, const std::pair<long long, PrimeStats>& b) {
+                      return a.first < b.first;
+                  });
+        PrimeStats all;
+        for (const std::pair<long long, PrimeStats>& p : pieces) all.append(p.second);
+        return all;
+    }
+
+private:
+    // One worker's segments so far: closed pieces and the one it is extending
+    struct alignas(CACHE_LINE_BYTES) ThreadPieces {
+        long long begin = 0;       // first segment of the open piece
+        long long next_seg = -1;   // segment that would extend it
+        PrimeStats open;
+        std::vector<std::pair<long long, PrimeStats>> closed;   // (first segment, piece)
+    };
+
+    static void close(ThreadPieces& t) {
+        if (t.open.num_bits > 0) t.closed.push_back({t.begin, t.open});
+        t.open = PrimeStats();
+    }
+
+    std::vector<ThreadPieces> threads_;
+};
+
+// Count and every statistic of ctx's range in one sieve pass, with the
+// executor in options. The prime 2 (never in a bitmap) is added here.
+inline PrimeStats prime_stats(const SieveContext& ctx, const SieveOptions& options, SieveTrace& trace) {
+    PrimeStatsCollector collector(options.threads);
+    run_executor(ctx, options, trace, collector);
+    PrimeStats stats = collector.finish();
+
+    if (ctx.even_prime_count() > 0) {
+        if (stats.first >= 0 && stats.first - 2 >= stats.max_gap) {
+            stats.max_gap = stats.first - 2;
+            stats.max_gap_start = 2;
+        }
+        if (stats.last < 0) stats.last = 2;
+        stats.first = 2;
+        stats.primes++;
+    }
+    return stats;
+}
+
+// Machine-readable statistics line (printed after the count line)
+inline void print_prime_stats(const PrimeStats& s) {
+    printf("twins=%lld cousins=%lld sexy=%lld triplets=%lld quadruplets=%lld max_gap=%lld max_gap_start=%lld\n",
+           s.tuples.twins, s.tuples.cousins, s.tuples.sexy, s.tuples.triplets, s.tuples.quadruplets,
+           s.max_gap, s.max_gap_start);
+}
@@ -0,0 +1,178 @@
+// ============================================================
+// sieve_stream.hpp — Streaming prime enumeration (primes, not just counts)
+// - stream_primes() / for_each_prime_block(): push API. The sink is called
+//   as sink(primes, n) with each segment's primes, in increasing order,
+//   and never concurrently, whichever executor does the sieving
+// - for_each_prime(): same, one call per prime
+// - PrimeGenerator: pull API, next(p) sieves one segment at a time on
+//   the calling thread
+// With a parallel executor, segments finish out of order. Each worker
+// writes its segment's primes into a slot of a bounded reorder buffer.
+// The worker that completes the oldest missing segment drains every
+// consecutive ready slot into the sink. A worker that runs more than
+// `window` segments ahead waits, so memory stays at about
+// window * (primes per segment) and never grows with N.
+// ============================================================
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "sieve_engine.hpp"
+#include "sieve_executors.hpp"
+
+// Streaming runs use short runs so the window (and its memory) stays small
+static const long long STREAM_RUN_SEGMENTS = 4;
+
+// ------------------------------------------------------------
+// Bounded reorder buffer: segments in, ordered blocks of primes out
+// ------------------------------------------------------------
+class OrderedPrimeBuffer {
+public:
+    // window: number of segments that may be buffered at once (>= 1)
+    explicit OrderedPrimeBuffer(long long window)
+        : window_(window > 0 ? window : 1),
+          slots_((size_t)window_),
+          ready_((size_t)window_, 0) {}
+
+    // Wait until segment seg_id has a free slot, then return that slot.
+    // The worker fills it and hands it back through publish().
+    std::vector<long long>& acquire(long long seg_id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [&] { return seg_id < next_ + window_; });
+        std::vector<long long>& slot = slots_[slot_of(seg_id)];
+        slot.clear();  // keeps its capacity, so steady state does not allocate
+        return slot;
+    }
+
+    // Mark segment seg_id ready. If no other thread is delivering, drain
+    // every consecutive ready segment into sink (calls are serialized).
+    template <typename Sink>
+    void publish(long long seg_id, Sink& sink) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_[slot_of(seg_id)] = 1;
+        if (delivering_) return;  // the current deliverer will pick it up
+        delivering_ = true;
+
+        while (ready_[slot_of(next_)]) {
+            std::vector<long long>& slot = slots_[slot_of(next_)];
+            lock.unlock();
+            if (!slot.empty()) sink(slot.data(), slot.size());
+            lock.lock();
+
+            ready_[slot_of(next_)] = 0;
+            next_++;
+            space_.notify_all();
+        }
+        delivering_ = false;
+    }
+
+private:
+    size_t slot_of(long long seg_id) const { return (size_t)(seg_id % window_); }
+
+    long long window_;
+    std::vector<std::vector<long long>> slots_;
+    std::vector<char> ready_;
+    long long next_ = 0;        // oldest segment not yet delivered
+    bool delivering_ = false;
+    std::mutex mutex_;
+    std::condition_variable space_;
+};
+
+// ------------------------------------------------------------
+// Push API
+// ------------------------------------------------------------
+
+// Stream every prime of ctx's range to sink(primes, n) in increasing order,
+// using the executor in options. Returns the prime count.
+template <typename Sink>
+long long stream_primes(const SieveContext& ctx, const SieveOptions& options,
+                        SieveTrace& trace, Sink&& sink) {
+    if (ctx.even_prime_count() > 0) {
+        long long two = 2;
+        sink(&two, (size_t)1);
+    }
+
+    SieveOptions stream_options = options;
+    stream_options.max_run_segments = std::min(options.max_run_segments, STREAM_RUN_SEGMENTS);
+
+    // Two runs per worker in flight keeps everyone busy while the
+    // oldest segment is still being sieved
+    int workers = options.executor == SieveExecutor::Serial ? 1 : std::max(1, options.threads);
+    long long run_length = plan_run_length(ctx, workers, stream_options.max_run_segments);
+    OrderedPrimeBuffer buffer(2LL * workers * run_length);
+
+    auto visit = [&](int, const SieveThreadState& state, const SegmentResult& r) {
+        std::vector<long long>& slot = buffer.acquire(r.seg_id);
+        slot.reserve((size_t)r.primes);
+        state.segment.for_each_set([&](long long value) { slot.push_back(value); });
+        buffer.publish(r.seg_id, sink);
+    };
+
+    return run_executor(ctx, stream_options, trace, visit);
+}
+
+// Stream the primes in [A, B] to sink(primes, n). Returns the prime count,
+// or -1 if the options are invalid (unsupported wheel).
+template <typename Sink>
+long long for_each_prime_block(long long A, long long B, const SieveOptions& options,
+                               SieveTrace& trace, Sink&& sink) {
+    SieveContext ctx;
+    if (!build_range_context(A, B, options, ctx, trace)) return -1;
+    return stream_primes(ctx, options, trace, sink);
+}
+
+// Call f(p) for every prime p in [A, B], in increasing order
+template <typename F>
+long long for_each_prime(long long A, long long B, const SieveOptions& options,
+                         SieveTrace& trace, F&& f) {
+    return for_each_prime_block(A, B, options, trace, [&](const long long* primes, size_t n) {
+        for (size_t i = 0; i < n; i++) f(primes[i]);
+    });
+}
+
+// ------------------------------------------------------------
+// Pull API: one segment at a time, on the calling thread
+// ------------------------------------------------------------
+class PrimeGenerator {
+public:
+    // Prepare to enumerate the primes in [A, B].
+    // Returns false if the options are invalid (unsupported wheel).
+    bool init(long long A, long long B, const SieveOptions& options = SieveOptions()) {
+        SieveTrace no_trace;
+        if (!build_range_context(A, B, options, ctx_, no_trace)) return false;
+
+        state_.init(ctx_.wheel, ctx_.seg_bits);
+        begin_run(state_, ctx_, 0, ctx_.num_segments);
+        next_segment_ = 0;
+        block_.clear();
+        pos_ = 0;
+        if (ctx_.even_prime_count() > 0) block_.push_back(2);
+        return true;
+    }
+
+    // Store the next prime in p. Returns false once the range is exhausted.
+    bool next(long long& p) {
+        while (pos_ == block_.size()) {
+            if (next_segment_ >= ctx_.num_segments) return false;
+            sieve_segment(state_, ctx_, next_segment_++);
+            block_.clear();
+            pos_ = 0;
+            state_.segment.for_each_set([&](long long value) { block_.push_back(value); });
+        }
+        p = block_[pos_++];
+        return true;
+    }
+
+    const SieveContext& context() const { return ctx_; }
+
+private:
+    SieveContext ctx_;
+    SieveThreadState state_;
+    std::vector<long long> block_;
+    size_t pos_ = 0;
+    long long next_segment_ = 0;
+};
@@ -0,0 +1,127 @@
+// ============================================================
+// sieve_trace.hpp — Low-overhead per-thread counters and tracing
+// Shared by sieve_serial.cpp and sieve_openmp.cpp
+// - Every worker thread owns one cache-line aligned ThreadTrace and
+//   updates it without locks or atomics
+// - Counters: segments, runs, marks written, primes counted, busy time
+//   (inside segment work), min/max time per segment, and idle time
+//   (time in the parallel region not spent on segments)
+// - Enabled at runtime with --trace <file.json>; the JSON is written
+//   once when the run finishes. When tracing is off the hot path only
+//   pays for one well-predicted null-pointer check per segment.
+// - Verbose console prints are a separate, compile-time switch
+//   (-DSIEVE_VERBOSE=1) and never run in benchmark builds
+// ============================================================
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sieve_bitset.hpp"
+
+// Verbose learning/debugging prints are compiled in only with -DSIEVE_VERBOSE=1
+#ifndef SIEVE_VERBOSE
+#define SIEVE_VERBOSE 0
+#endif
+
+inline double trace_now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct alignas(CACHE_LINE_BYTES) ThreadTrace {
+    long long segments = 0;
+    long long runs = 0;
+    long long marks = 0;        // bits cleared by small-prime and bucket marking
+    long long primes = 0;       // survivors counted in this thread's segments
+    double busy_sec = 0.0;      // time spent inside segment work
+    double region_sec = 0.0;    // time spent inside the parallel region
+    double min_segment_sec = 0.0;
+    double max_segment_sec = 0.0;
+    long long steals = 0;       // blocks taken from other workers (steal executor)
+    int node = -1;              // NUMA node / pinned CPU (numa executor only)
+    int cpu = -1;
+
+    void record_segment(double seconds, long long marks_written, long long primes_found) {
+        if (segments == 0 || seconds < min_segment_sec) min_segment_sec = seconds;
+        if (seconds > max_segment_sec) max_segment_sec = seconds;
+        segments++;
+        marks += marks_written;
+        primes += primes_found;
+        busy_sec += seconds;
+    }
+
+    double idle_sec() const {
+        return region_sec > busy_sec ? region_sec - busy_sec : 0.0;
+    }
+};
+
+class SieveTrace {
+public:
+    void enable(int num_threads) {
+        enabled_ = true;
+        threads_.assign((size_t)(num_threads > 0 ? num_threads : 1), ThreadTrace());
+    }
+
+    bool enabled() const { return enabled_; }
+
+    // Returns this thread's trace, or nullptr when tracing is off
+    ThreadTrace* thread(int tid) {
+        return enabled_ ? &threads_[(size_t)tid] : nullptr;
+    }
+
+    // Named wall-clock phases (e.g. base primes, sieve) in run order
+    void add_phase(const std::string& name, double seconds) {
+        if (enabled_) phases_.push_back({name, seconds});
+    }
+
+    // Extra top-level key/value pairs describing the run (N, wheel, ...)
+    void add_param(const std::string& name, long long value) {
+        if (enabled_) params_.push_back({name, value});
+    }
+
+    bool write_json(const std::string& path) const {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+
+        fprintf(f, "{\n");
+        for (const auto& p : params_) {
+            fprintf(f, "  \"%s\": %lld,\n", p.first.c_str(), p.second);
+        }
+
+        fprintf(f, "  \"phases\": {");
+        for (size_t i = 0; i < phases_.size(); i++) {
+            fprintf(f, "%s\"%s\": %.9f", i ? ", " : "", phases_[i].first.c_str(), phases_[i].second);
+        }
+        fprintf(f, "},\n");
+
+        fprintf(f, "  \"workers\": [\n");
+        for (size_t t = 0; t < threads_.size(); t++) {
+            const ThreadTrace& tt = threads_[t];
+            double avg = tt.segments ? tt.busy_sec / (double)tt.segments : 0.0;
+            fprintf(f,
+                    "    {\"tid\": %zu, \"segments\": %lld, \"runs\": %lld, \"marks\": %lld, "
+                    "\"primes\": %lld, \"busy_sec\": %.9f, \"idle_sec\": %.9f, "
+                    "\"avg_segment_us\": %.3f, \"min_segment_us\": %.3f, \"max_segment_us\": %.3f",
+                    t, tt.segments, tt.runs, tt.marks, tt.primes, tt.busy_sec, tt.idle_sec(),
+                    avg * 1e6, tt.min_segment_sec * 1e6, tt.max_segment_sec * 1e6);
+            if (tt.steals > 0) fprintf(f, ", \"steals\": %lld", tt.steals);
+            if (tt.node >= 0) fprintf(f, ", \"node\": %d, \"cpu\": %d", tt.node, tt.cpu);
+            fprintf(f, "}%s\n", t + 1 < threads_.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+
+        fclose(f);
+        return true;
+    }
+
+private:
+    bool enabled_ = false;
+    std::vector<ThreadTrace> threads_;
+    std::vector<std::pair<std::string, double>> phases_;
+    std::vector<std::pair<std::string, long long>> params_;
+};
@@ -0,0 +1,265 @@
+// ============================================================
+// sieve_wheel.hpp — Wheel factorization pre-pattern for segments
+// Shared by sieve_serial.cpp and sieve_openmp.cpp
+// - A wheel of modulus M = 2 * 3 * 5 * ... removes multiples of its
+//   small odd primes up front
+// - In odd-only bit space (bit k <-> odd number 2k+1) multiples of an
+//   odd prime q repeat every q bits, so the combined pattern repeats
+//   every M/2 bits
+// - Segments are initialized by copying that pattern at the right
+//   phase instead of setting all bits and striking 3, 5, 7, ... one
+//   multiple at a time; the marking loop then skips the wheel primes
+// - align() adds word-aligned copies for the SIMD fill path: the wheel
+//   pattern laid out so whole words can be copied (no shifting), plus
+//   pre-sieve patterns for the next primes above the wheel (17..127 by
+//   default) that are ANDed in word by word (see sieve_simd.hpp)
+// - The aligned tables are read-only once built and shared (shared_ptr)
+//   by every copy of the WheelPattern, so worker threads do not each
+//   copy them; own_tables() makes a private copy (NUMA node replicas)
+// Supported moduli: 2 (off), 6, 30, 210, 2310, 30030, 510510
+// Patterns up to 30030 are copied from compile-time tables
+// (sieve_small_primes.hpp); 510510 is built at runtime.
+// ============================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "sieve_bitset.hpp"
+#include "sieve_simd.hpp"
+#include "sieve_small_primes.hpp"
+
+// Largest aligned wheel table align() builds, in 64-bit words (256 KiB);
+// the 510510 wheel (255255 words) keeps the shifting path only
+static const long long MAX_ALIGNED_WHEEL_WORDS = 1LL << 15;
+
+// Default pre-sieve: primes 17..127 are ANDed in as patterns
+static const int DEFAULT_PRESIEVE_LIMIT = 127;
+
+// Largest accepted pre-sieve limit. A pattern costs one AND per segment
+// word, while marking prime q only touches one bit in q; past a few
+// hundred the patterns stop paying off (timings are flat from 127 to
+// about 500, then get worse) while their tables keep growing. Up to 256
+// the 40 patterns take about 50 KiB.
+static const int MAX_PRESIEVE_LIMIT = 256;
+
+// Pre-sieve pattern for one prime q: bit k of the aligned word layout is 0
+// exactly when 2k+1 is a multiple of q. Repeats every q words; stored as a
+// whole number of periods of at least 64 words so SIMD chunks stay long
+struct PresievePattern {
+    int prime = 0;
+    std::vector<uint64_t> keep;
+};
+
+// Apply kernel(dst, table + pos, len) over n words of dst, where dst word 0
+// lines up with table word w % table.size() and the table repeats
+inline void apply_cyclic(void (*kernel)(uint64_t*, const uint64_t*, size_t),
+                         uint64_t* dst, size_t n, const std::vector<uint64_t>& table, long long w) {
+    size_t pos = (size_t)(w % (long long)table.size());
+    while (n > 0) {
+        size_t len = std::min(n, table.size() - pos);
+        kernel(dst, table.data() + pos, len);
+        dst += len;
+        n -= len;
+        pos = 0;
+    }
+}
+
+// Word-aligned tables built by WheelPattern::align(), read-only afterwards
+struct AlignedWheelTables {
+    std::vector<uint64_t> aligned;          // pattern words for global bit 64w + aligned_shift
+    std::vector<PresievePattern> presieve;  // primes above the wheel, increasing
+};
+
+struct WheelPattern {
+    long long modulus = 2;          // 2 = wheel off (odd-only sieve only)
+    std::vector<int> primes;        // odd primes folded into the pattern
+    long long period = 1;           // stored pattern length in bits
+    std::vector<uint64_t> bits;     // pattern plus 64 bits of wrap-around
+
+    // Filled by align(); none = shifting path only. Shared by copies.
+    long long aligned_shift = -1;          // (low-1)/2 % 64 of the segments the tables fit
+    std::shared_ptr<const AlignedWheelTables> tables;
+
+    // Returns false if modulus is not a primorial we support
+    bool build(long long wheel_modulus) {
+        static const int WHEEL_PRIMES[] = {3, 5, 7, 11, 13, 17};
+
+        primes.clear();
+        aligned_shift = -1;
+        tables.reset();
+        long long m = 2;
+        for (int q : WHEEL_PRIMES) {
+            if (m >= wheel_modulus) break;
+            m *= q;
+            primes.push_back(q);
+        }
+        if (m != wheel_modulus) return false;
+        modulus = wheel_modulus;
+
+        switch (modulus) {
+            case 6:     copy_table<6>();     return true;
+            case 30:    copy_table<30>();    return true;
+            case 210:   copy_table<210>();   return true;
+            case 2310:  copy_table<2310>();  return true;
+            case 30030: copy_table<30030>(); return true;
+            default:    break;
+        }
+
+        // Base period is M/2 bits. Tiny periods (wheel 2 or 6) are repeated
+        // until the stored pattern is at least 4096 bits long, so fill()
+        // needs at most one wrap-around subtraction per 64-bit word.
+        long long base_period = modulus / 2;
+        period = base_period;
+        while (period < 4096) period += base_period;
+
+        long long stored_bits = period + 64;
+        bits.assign((size_t)((stored_bits + 63) / 64) + 1, 0);
+        for (long long k = 0; k < stored_bits; k++) {
+            long long n = 2 * k + 1;
+            bool coprime = true;
+            for (int q : primes) {
+                if (n % q == 0) { coprime = false; break; }
+            }
+            if (coprime) bits[(size_t)(k >> 6)] |= 1ULL << (k & 63);
+        }
+        return true;
+    }
+
+    // The pattern of a wheel with a compile-time table
+    template <long long M>
+    void copy_table() {
+        period = WheelTable<M>::period;
+        bits.assign(WheelTable<M>::bits.begin(), WheelTable<M>::bits.end());
+    }
+
+    bool enabled() const { return !primes.empty(); }
+
+    // The aligned tables (empty without align())
+    const std::vector<uint64_t>& aligned_words() const {
+        static const std::vector<uint64_t> none;
+        return tables ? tables->aligned : none;
+    }
+
+    const std::vector<PresievePattern>& presieve_patterns() const {
+        static const std::vector<PresievePattern> none;
+        return tables ? tables->presieve : none;
+    }
+
+    // Give this copy its own tables, allocated by the calling thread
+    void own_tables() {
+        if (tables) tables = std::make_shared<const AlignedWheelTables>(*tables);
+    }
+
+    // Largest prime removed by the pattern (marking loops skip p <= this)
+    int largest_prime() const {
+        const std::vector<PresievePattern>& presieve = presieve_patterns();
+        if (!presieve.empty()) return presieve.back().prime;
+        return primes.empty() ? 2 : primes.back();
+    }
+
+    // 64 pattern bits starting at bit pos (0 <= pos < period)
+    uint64_t pattern_word(long long pos) const {
+        size_t q = (size_t)(pos >> 6);
+        int r = (int)(pos & 63);
+        return (r == 0) ? bits[q] : ((bits[q] >> r) | (bits[q + 1] << (64 - r)));
+    }
+
+    // Build the word-aligned tables for segments whose first bit
+    // k = (low-1)/2 has k % 64 == bit_offset. Every segment of one run
+    // qualifies: segments are a multiple of 64 bits long. Odd primes in
+    // (largest wheel prime, presieve_limit] get pre-sieve patterns and are
+    // then skipped by the marking loop like the wheel primes; the limit is
+    // capped at MAX_PRESIEVE_LIMIT.
+    void align(int bit_offset, int presieve_limit) {
+        aligned_shift = -1;
+        tables.reset();
+        if (!enabled() || period > MAX_ALIGNED_WHEEL_WORDS) return;
+        aligned_shift = bit_offset;
+        presieve_limit = std::min(presieve_limit, MAX_PRESIEVE_LIMIT);
+
+        std::shared_ptr<AlignedWheelTables> built = std::make_shared<AlignedWheelTables>();
+        std::vector<uint64_t>& aligned = built->aligned;
+        std::vector<PresievePattern>& presieve = built->presieve;
+
+        // Word w holds global bits 64w + bit_offset ...; after period words
+        // the bit position has advanced by 64 * period, a whole number of periods
+        aligned.resize((size_t)period);
+        long long pos = bit_offset % period;
+        for (long long w = 0; w < period; w++) {
+            aligned[(size_t)w] = pattern_word(pos);
+            pos += 64;
+            if (pos >= period) pos -= period;   // period >= 4096
+        }
+
+        for (int q = primes.back() + 2; q <= presieve_limit; q += 2) {
+            bool is_prime = true;
+            for (int d = 3; d * d <= q; d += 2) {
+                if (q % d == 0) { is_prime = false; break; }
+            }
+            if (!is_prime) continue;
+
+            // Bit k is a multiple of q when 2k+1 = 0 (mod q), i.e. k = (q-1)/2 (mod q)
+            PresievePattern p;
+            p.prime = q;
+            long long words = q * ((64 + q - 1) / q);
+            p.keep.assign((size_t)words, ~0ULL);
+            for (long long k = (q - 1) / 2 - bit_offset % q; k < words * 64; k += q) {
+                if (k >= 0) p.keep[(size_t)(k >> 6)] &= ~(1ULL << (k & 63));
+            }
+            presieve.push_back(p);
+        }
+        tables = built;
+    }
+
+    // Initialize seg for the odd values low, low+2, ..., low+2*(num_bits-1).
+    // Wheel and pre-sieve primes that fall inside the segment are restored
+    // afterwards, since the patterns clear the primes themselves along with
+    // their multiples.
+    void fill(SegmentBitset& seg, long long low, long long num_bits) const {
+        if (!enabled()) {
+            seg.reset(low, num_bits);
+            return;
+        }
+
+        seg.prepare(low, num_bits);
+        long long k = (low - 1) / 2;
+        size_t num_words = seg.word_count();
+
+        const std::vector<PresievePattern>& presieve = presieve_patterns();
+        if (aligned_shift >= 0 && k >= aligned_shift && (k - aligned_shift) % 64 == 0) {
+            // Aligned: straight word copies and ANDs with the SIMD kernels
+            long long w = (k - aligned_shift) / 64;
+            const SimdKernels& simd = simd_kernels();
+            apply_cyclic(simd.copy_words, seg.words.data(), num_words, tables->aligned, w);
+            for (const PresievePattern& p : presieve) {
+                apply_cyclic(simd.and_words, seg.words.data(), num_words, p.keep, w);
+            }
+        } else {
+            // Any other phase: shift the pattern into place word by word
+            long long pos = k % period;
+            for (size_t w = 0; w < num_words; w++) {
+                seg.words[w] = pattern_word(pos);
+                pos += 64;
+                if (pos >= period) pos -= period;
+            }
+            for (const PresievePattern& p : presieve) {
+                long long q = p.prime;
+                for (long long i = ((q - 1) / 2 - k % q + q) % q; i < num_bits; i += q) seg.clear(i);
+            }
+        }
+        seg.mask_tail();
+
+        long long high = low + 2 * (num_bits - 1);
+        for (int q : primes) {
+            if (q >= low && q <= high) seg.set((q - low) / 2);
+        }
+        for (const PresievePattern& p : presieve) {
+            if (p.prime >= low && p.prime <= high) seg.set((p.prime - low) / 2);
+        }
+    }
+};